@@ -32,6 +32,9 @@ $(call compile_only_if,$(CONFIG_LV_TFT_DISPLAY_CONTROLLER_RA8875),lvgl_tft/ra887
 $(call compile_only_if,$(CONFIG_LV_TFT_DISPLAY_CONTROLLER_GC9A01),lvgl_tft/GC9A01.o)
 
 $(call compile_only_if,$(CONFIG_LV_TFT_DISPLAY_PROTOCOL_SPI),lvgl_tft/disp_spi.o)
+$(call compile_only_if,$(CONFIG_LV_TFT_DISPLAY_PROTOCOL_SPI),lvgl_tft/disp_fill.o)
+$(call compile_only_if,$(or $(CONFIG_LV_TFT_DISPLAY_CONTROLLER_ILI9481),$(CONFIG_LV_TFT_DISPLAY_CONTROLLER_ILI9488)),lvgl_tft/disp_rgb666.o)
+$(call compile_only_if,$(or $(CONFIG_LV_TFT_DISPLAY_CONTROLLER_ILI9341),$(CONFIG_LV_TFT_DISPLAY_CONTROLLER_ST7789),$(CONFIG_LV_TFT_DISPLAY_CONTROLLER_ST7796S),$(CONFIG_LV_TFT_DISPLAY_CONTROLLER_GC9A01),$(CONFIG_LV_TFT_DISPLAY_CONTROLLER_HX8357),$(CONFIG_LV_TFT_DISPLAY_CONTROLLER_ILI9486),$(CONFIG_LV_TFT_DISPLAY_CONTROLLER_ILI9481),$(CONFIG_LV_TFT_DISPLAY_CONTROLLER_ILI9488)),lvgl_tft/disp_mipi.o)
 
 # Touch controller drivers
 COMPONENT_ADD_INCLUDEDIRS += lvgl_touch
@@ -17,6 +17,12 @@
 #include "lvgl_i2c_conf.h"
 
 #include "driver/i2c.h"
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
 
 #ifdef LV_LVGL_H_INCLUDE_SIMPLE
 #include "src/core/lv_refr.h"
@@ -30,17 +36,58 @@
 
  #define TAG "lvgl_helpers"
 
+/* Controllers with an init sequence besides the display */
+#if defined (CONFIG_LV_TFT_DISPLAY_CONTROLLER_FT81X)
+#if defined (CONFIG_LV_TOUCH_CONTROLLER_FT81X)
+#define TOUCH_INIT
+#endif
+#elif CONFIG_LV_TOUCH_CONTROLLER != TOUCH_CONTROLLER_NONE
+#define TOUCH_INIT
+#endif
+
+/* The touch init sequence can run next to the display one when neither
+ * shares a bus or a controller with the other */
+#if defined (TOUCH_INIT) && \
+    !defined (CONFIG_LV_TFT_DISPLAY_CONTROLLER_FT81X) && \
+    !defined (SHARED_SPI_BUS) && !defined (SHARED_I2C_BUS) && \
+    !defined (CONFIG_LV_TOUCH_DRIVER_DISPLAY)
+#define TOUCH_INIT_TASK
+#define TOUCH_INIT_TASK_STACK_SIZE  4096
+#endif
+
+/* Splash rows per flush, a multiple of the 8 rows of the monochrome pages */
+#define SPLASH_STRIPE_LINES 16
+
 /**********************
  *      TYPEDEFS
  **********************/
 
+/* Decoder state, packets may span several stripes */
+typedef struct {
+    const uint8_t *src;
+    const uint8_t *end;
+    uint16_t left;      /* pixels left in the current packet */
+    bool run;
+    uint16_t run_px;
+} splash_rle_t;
+
 /**********************
  *  STATIC PROTOTYPES
  **********************/
+static void buses_init(void);
+static void splash_decode(splash_rle_t *rle, uint16_t *dst, size_t pixels);
+static lv_color_t splash_color(uint16_t rgb565);
+#if defined (TOUCH_INIT_TASK)
+static void touch_init_task(void *arg);
+#endif
 
 /**********************
  *  STATIC VARIABLES
  **********************/
+#if defined (TOUCH_INIT_TASK)
+static SemaphoreHandle_t touch_init_done;
+static int64_t touch_init_us;
+#endif
 
 /**********************
  *      MACROS
@@ -50,114 +97,194 @@
  *   GLOBAL FUNCTIONS
  **********************/
 
-/* Interface and driver initialization */
+/* Interface and driver initialization
+ *
+ * Done in phases: the buses and devices first, then the controller init
+ * sequences, the touch one on a task of its own when it doesn't share
+ * anything with the display. */
 void lvgl_driver_init(void)
 {
     ESP_LOGI(TAG, "Display hor size: %d, ver size: %d", CONFIG_LV_HOR_RES_MAX, CONFIG_LV_VER_RES_MAX);
     ESP_LOGI(TAG, "Display buffer size: %d", DISP_BUF_SIZE);
 
-#if defined (CONFIG_LV_TFT_DISPLAY_CONTROLLER_FT81X)
-    ESP_LOGI(TAG, "Initializing SPI master for FT81X");
+    int64_t start = esp_timer_get_time();
 
-    lvgl_spi_driver_init(TFT_SPI_HOST,
-        DISP_SPI_MISO, DISP_SPI_MOSI, DISP_SPI_CLK,
-        SPI_BUS_MAX_TRANSFER_SZ, 1,
-        DISP_SPI_IO2, DISP_SPI_IO3);
-    
-    disp_spi_add_device(TFT_SPI_HOST);
-    disp_driver_init();
+    buses_init();
 
-#if defined (CONFIG_LV_TOUCH_CONTROLLER_FT81X)
-    touch_driver_init();
-#endif
+    int64_t buses_end = esp_timer_get_time();
 
-    return;
-#endif
+#if defined (TOUCH_INIT_TASK)
+    touch_init_done = xSemaphoreCreateBinary();
+    assert(touch_init_done != NULL);
 
-#if defined (SHARED_SPI_BUS)
-    ESP_LOGI(TAG, "Initializing shared SPI master");
+    BaseType_t ret = xTaskCreate(touch_init_task, "touch_init", TOUCH_INIT_TASK_STACK_SIZE,
+        NULL, uxTaskPriorityGet(NULL), NULL);
+    assert(ret == pdPASS);
+#endif
 
-    lvgl_spi_driver_init(TFT_SPI_HOST,
-        TP_SPI_MISO, DISP_SPI_MOSI, DISP_SPI_CLK,
-        SPI_BUS_MAX_TRANSFER_SZ, 1,
-        -1, -1);
-    
-    disp_spi_add_device(TFT_SPI_HOST);
-    tp_spi_add_device(TOUCH_SPI_HOST);
-    
     disp_driver_init();
-    touch_driver_init();
 
-    return;
-#endif
+    int64_t disp_end = esp_timer_get_time();
 
-#if defined (SHARED_I2C_BUS)
-    ESP_LOGI(TAG, "Initializing shared I2C master");
-    
-    lvgl_i2c_driver_init(DISP_I2C_PORT,
-        DISP_I2C_SDA, DISP_I2C_SCL,
-        DISP_I2C_SPEED_HZ);
-    
-    disp_driver_init();
+#if defined (TOUCH_INIT_TASK)
+    xSemaphoreTake(touch_init_done, portMAX_DELAY);
+    vSemaphoreDelete(touch_init_done);
+    touch_init_done = NULL;
+#elif defined (TOUCH_INIT)
     touch_driver_init();
-    
-    return;
+    int64_t touch_init_us = esp_timer_get_time() - disp_end;
 #endif
 
-/* Display controller initialization */
-#if defined CONFIG_LV_TFT_DISPLAY_INIT
-    disp_driver_init();
-#elif defined CONFIG_LV_TFT_DISPLAY_PROTOCOL_SPI
-    ESP_LOGI(TAG, "Initializing SPI master for display");
-    
-    lvgl_spi_driver_init(TFT_SPI_HOST,
-        DISP_SPI_MISO, DISP_SPI_MOSI, DISP_SPI_CLK,
-        SPI_BUS_MAX_TRANSFER_SZ, SPI_DMA_CH_AUTO,
-        DISP_SPI_IO2, DISP_SPI_IO3);
-    
-    disp_spi_add_device(TFT_SPI_HOST);
-    disp_driver_init();
-#elif defined (CONFIG_LV_TFT_DISPLAY_PROTOCOL_I2C)
-    ESP_LOGI(TAG, "Initializing I2C master for display");
-    /* Init the i2c master on the display driver code */
-    lvgl_i2c_driver_init(DISP_I2C_PORT,
-        DISP_I2C_SDA, DISP_I2C_SCL,
-        DISP_I2C_SPEED_HZ);
-    
-    disp_driver_init();
+    int64_t end = esp_timer_get_time();
+
+    ESP_LOGI(TAG, "Drivers initialized in %d ms: buses %d ms, display %d ms",
+        (int) ((end - start) / 1000), (int) ((buses_end - start) / 1000),
+        (int) ((disp_end - buses_end) / 1000));
+#if defined (TOUCH_INIT_TASK)
+    ESP_LOGI(TAG, "Touch %d ms, alongside the display", (int) (touch_init_us / 1000));
+#elif defined (TOUCH_INIT)
+    ESP_LOGI(TAG, "Touch %d ms, after the display", (int) (touch_init_us / 1000));
+#endif
+}
+
+/* Allocate the draw buffers used for double buffered flushing */
+bool lvgl_alloc_draw_buffers(lv_color_t **buf1, lv_color_t **buf2)
+{
+    assert((buf1 != NULL) && (buf2 != NULL));
+
+    *buf1 = heap_caps_malloc(DISP_BUF_SIZE * sizeof(lv_color_t), MALLOC_CAP_DMA);
+    *buf2 = heap_caps_malloc(DISP_BUF_SIZE * sizeof(lv_color_t), MALLOC_CAP_DMA);
+
+    if ((*buf1 == NULL) || (*buf2 == NULL)) {
+        ESP_LOGE(TAG, "Could not allocate the draw buffers (2 x %d bytes)",
+            (int) (DISP_BUF_SIZE * sizeof(lv_color_t)));
+        heap_caps_free(*buf1);
+        heap_caps_free(*buf2);
+        *buf1 = NULL;
+        *buf2 = NULL;
+        return false;
+    }
+
+    return true;
+}
+
+/* Paint a splash image through the display driver, see lvgl_helpers.h */
+bool lvgl_splash_draw(const uint8_t *rle, size_t rle_size, lv_coord_t w, lv_coord_t h,
+    uint16_t bg_rgb565)
+{
+#if defined (DISP_DRIVER_EPAPER)
+    /* the e-paper flushes refresh the whole panel out of a full frame */
+    ESP_LOGW(TAG, "No splash on e-paper panels");
+    (void) rle; (void) rle_size; (void) w; (void) h; (void) bg_rgb565;
+    return false;
 #else
-#error "No protocol defined for display controller"
+    const lv_coord_t hor_res = LV_HOR_RES_MAX;
+    const lv_coord_t ver_res = LV_VER_RES_MAX;
+    const lv_coord_t img_x = (hor_res - w) / 2;
+    const lv_coord_t img_y = (ver_res - h) / 2;
+    int64_t start = esp_timer_get_time();
+
+    assert(w <= hor_res && h <= ver_res);
+
+    /* a bare driver, only as the argument lv_disp_flush_ready needs, the
+       flushes are waited for through disp_driver_wait_flush */
+    static lv_disp_drv_t drv;
+    lv_disp_drv_init(&drv);
+    drv.hor_res = hor_res;
+    drv.ver_res = ver_res;
+
+    /* the rounder may grow the stripes, e.g. to whole pages */
+    lv_area_t area = {0, 0, hor_res - 1, SPLASH_STRIPE_LINES - 1};
+    disp_driver_rounder(&drv, &area);
+    size_t capacity = lv_area_get_size(&area);
+    if (capacity < (size_t) hor_res * SPLASH_STRIPE_LINES) {
+        capacity = (size_t) hor_res * SPLASH_STRIPE_LINES;
+    }
+
+    lv_color_t *stripes[2];
+    stripes[0] = heap_caps_malloc(capacity * sizeof(lv_color_t), MALLOC_CAP_DMA);
+    stripes[1] = heap_caps_malloc(capacity * sizeof(lv_color_t), MALLOC_CAP_DMA);
+    uint16_t *row = heap_caps_malloc(hor_res * sizeof(uint16_t), MALLOC_CAP_8BIT);
+
+    if ((stripes[0] == NULL) || (stripes[1] == NULL) || (row == NULL)) {
+        ESP_LOGE(TAG, "Could not allocate the splash stripes (2 x %d bytes)",
+            (int) (capacity * sizeof(lv_color_t)));
+        heap_caps_free(stripes[0]);
+        heap_caps_free(stripes[1]);
+        heap_caps_free(row);
+        return false;
+    }
+
+    /* lv_disp_flush_ready clears the flushing flag of the driver buffer */
+#if (LVGL_VERSION_MAJOR >= 8)
+    static lv_disp_draw_buf_t buf;
+    lv_disp_draw_buf_init(&buf, stripes[0], stripes[1], capacity);
+    drv.draw_buf = &buf;
+#else
+    static lv_disp_buf_t buf;
+    lv_disp_buf_init(&buf, stripes[0], stripes[1], capacity);
+    drv.buffer = &buf;
 #endif
 
-/* Touch controller initialization */
-#if CONFIG_LV_TOUCH_CONTROLLER != TOUCH_CONTROLLER_NONE
-    #if defined (CONFIG_LV_TOUCH_DRIVER_PROTOCOL_SPI)
-        ESP_LOGI(TAG, "Initializing SPI master for touch");
-        
-        lvgl_spi_driver_init(TOUCH_SPI_HOST,
-            TP_SPI_MISO, TP_SPI_MOSI, TP_SPI_CLK,
-            0 /* Defaults to 4094 */, 2,
-            -1, -1);
-        
-        tp_spi_add_device(TOUCH_SPI_HOST);
-        
-        touch_driver_init();
-    #elif defined (CONFIG_LV_TOUCH_DRIVER_PROTOCOL_I2C)
-        ESP_LOGI(TAG, "Initializing I2C master for touch");
-        
-        lvgl_i2c_driver_init(TOUCH_I2C_PORT,
-            TOUCH_I2C_SDA, TOUCH_I2C_SCL,
-            TOUCH_I2C_SPEED_HZ);
-        
-        touch_driver_init();
-    #elif defined (CONFIG_LV_TOUCH_DRIVER_ADC)
-        touch_driver_init();
-    #elif defined (CONFIG_LV_TOUCH_DRIVER_DISPLAY)
-        touch_driver_init();
-    #else
-    #error "No protocol defined for touch controller"
-    #endif
+    splash_rle_t dec = {
+        .src = rle,
+        .end = rle + rle_size,
+    };
+    unsigned active = 0;
+
+    for (lv_coord_t y = 0; y < ver_res; y = area.y2 + 1) {
+        area.x1 = 0;
+        area.y1 = y;
+        area.x2 = hor_res - 1;
+        area.y2 = (y + SPLASH_STRIPE_LINES < ver_res ? y + SPLASH_STRIPE_LINES : ver_res) - 1;
+        disp_driver_rounder(&drv, &area);
+
+        if (area.y1 < y || lv_area_get_size(&area) > capacity) {
+            /* rounded back over painted rows or bigger than the first stripe */
+            ESP_LOGE(TAG, "Splash stripe at line %d doesn't fit the display rounder", y);
+            break;
+        }
+
+        /* the other stripe may still be on its way, this one was flushed
+           before it was queued */
+        lv_color_t *dst = stripes[active];
+        lv_coord_t stripe_w = lv_area_get_width(&area);
+
+        for (lv_coord_t ry = area.y1; ry <= area.y2; ry++) {
+            for (lv_coord_t x = 0; x < hor_res; x++) {
+                row[x] = bg_rgb565;
+            }
+            if (ry >= img_y && ry < img_y + h) {
+                splash_decode(&dec, row + img_x, w);
+            }
+
+#if defined (DISP_DRIVER_SET_PX)
+            for (lv_coord_t x = area.x1; x <= area.x2; x++) {
+                disp_driver_set_px(&drv, (uint8_t *) dst, stripe_w, x - area.x1, ry - area.y1,
+                    splash_color(row[x]), LV_OPA_COVER);
+            }
 #else
+            lv_color_t *line = dst + (size_t) (ry - area.y1) * stripe_w;
+            for (lv_coord_t x = area.x1; x <= area.x2; x++) {
+                line[x - area.x1] = splash_color(row[x]);
+            }
+#endif
+        }
+
+        disp_driver_wait_flush();
+        disp_driver_flush(&drv, &area, dst);
+        active ^= 1;
+    }
+
+    disp_driver_wait_flush();
+
+    heap_caps_free(stripes[0]);
+    heap_caps_free(stripes[1]);
+    heap_caps_free(row);
+
+    ESP_LOGI(TAG, "Splash painted in %d ms", (int) ((esp_timer_get_time() - start) / 1000));
+
+    return true;
 #endif
 }
 
@@ -244,3 +371,162 @@ bool lvgl_spi_driver_init(int host,
     return ESP_OK != ret;
 }
 
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+/* Bring up the buses and add the devices, nothing here waits on a controller */
+static void buses_init(void)
+{
+#if defined (CONFIG_LV_TFT_DISPLAY_CONTROLLER_FT81X)
+    ESP_LOGI(TAG, "Initializing SPI master for FT81X");
+
+    lvgl_spi_driver_init(TFT_SPI_HOST,
+        DISP_SPI_MISO, DISP_SPI_MOSI, DISP_SPI_CLK,
+        SPI_BUS_MAX_TRANSFER_SZ, 1,
+        DISP_SPI_IO2, DISP_SPI_IO3);
+    
+    disp_spi_add_device(TFT_SPI_HOST);
+#elif defined (SHARED_SPI_BUS)
+    ESP_LOGI(TAG, "Initializing shared SPI master");
+
+    lvgl_spi_driver_init(TFT_SPI_HOST,
+        TP_SPI_MISO, DISP_SPI_MOSI, DISP_SPI_CLK,
+        SPI_BUS_MAX_TRANSFER_SZ, 1,
+        -1, -1);
+    
+    disp_spi_add_device(TFT_SPI_HOST);
+    tp_spi_add_device(TOUCH_SPI_HOST);
+#elif defined (SHARED_I2C_BUS)
+    ESP_LOGI(TAG, "Initializing shared I2C master");
+    
+    lvgl_i2c_driver_init(DISP_I2C_PORT,
+        DISP_I2C_SDA, DISP_I2C_SCL,
+        DISP_I2C_SPEED_HZ);
+#else
+
+/* Display controller bus */
+#if defined CONFIG_LV_TFT_DISPLAY_INIT
+    /* Initialized by the display driver */
+#elif defined CONFIG_LV_TFT_DISPLAY_PROTOCOL_SPI
+    ESP_LOGI(TAG, "Initializing SPI master for display");
+    
+    lvgl_spi_driver_init(TFT_SPI_HOST,
+        DISP_SPI_MISO, DISP_SPI_MOSI, DISP_SPI_CLK,
+        SPI_BUS_MAX_TRANSFER_SZ, SPI_DMA_CH_AUTO,
+        DISP_SPI_IO2, DISP_SPI_IO3);
+    
+    disp_spi_add_device(TFT_SPI_HOST);
+#elif defined (CONFIG_LV_TFT_DISPLAY_PROTOCOL_I2C)
+    ESP_LOGI(TAG, "Initializing I2C master for display");
+    /* Init the i2c master on the display driver code */
+    lvgl_i2c_driver_init(DISP_I2C_PORT,
+        DISP_I2C_SDA, DISP_I2C_SCL,
+        DISP_I2C_SPEED_HZ);
+#else
+#error "No protocol defined for display controller"
+#endif
+
+/* Touch controller bus */
+#if CONFIG_LV_TOUCH_CONTROLLER != TOUCH_CONTROLLER_NONE
+    #if defined (CONFIG_LV_TOUCH_DRIVER_PROTOCOL_SPI)
+        ESP_LOGI(TAG, "Initializing SPI master for touch");
+        
+        lvgl_spi_driver_init(TOUCH_SPI_HOST,
+            TP_SPI_MISO, TP_SPI_MOSI, TP_SPI_CLK,
+            0 /* Defaults to 4094 */, 2,
+            -1, -1);
+        
+        tp_spi_add_device(TOUCH_SPI_HOST);
+    #elif defined (CONFIG_LV_TOUCH_DRIVER_PROTOCOL_I2C)
+        ESP_LOGI(TAG, "Initializing I2C master for touch");
+        
+        lvgl_i2c_driver_init(TOUCH_I2C_PORT,
+            TOUCH_I2C_SDA, TOUCH_I2C_SCL,
+            TOUCH_I2C_SPEED_HZ);
+    #elif defined (CONFIG_LV_TOUCH_DRIVER_ADC)
+    #elif defined (CONFIG_LV_TOUCH_DRIVER_DISPLAY)
+    #else
+    #error "No protocol defined for touch controller"
+    #endif
+#endif
+
+#endif
+}
+
+#if defined (TOUCH_INIT_TASK)
+static void touch_init_task(void *arg)
+{
+    int64_t start = esp_timer_get_time();
+
+    touch_driver_init();
+
+    touch_init_us = esp_timer_get_time() - start;
+    xSemaphoreGive(touch_init_done);
+    vTaskDelete(NULL);
+}
+#endif
+
+static void splash_decode(splash_rle_t *rle, uint16_t *dst, size_t pixels)
+{
+    while (pixels > 0) {
+        if (rle->left == 0) {
+            if (rle->end - rle->src < 2) {
+                /* truncated image, the rest stays background */
+                return;
+            }
+            uint16_t header = rle->src[0] | (rle->src[1] << 8);
+            rle->src += 2;
+            rle->run = header & 0x8000;
+            rle->left = header & 0x7FFF;
+            if (rle->run) {
+                if (rle->end - rle->src < 2) {
+                    rle->left = 0;
+                    return;
+                }
+                rle->run_px = rle->src[0] | (rle->src[1] << 8);
+                rle->src += 2;
+            }
+            continue;
+        }
+
+        size_t n = rle->left < pixels ? rle->left : pixels;
+
+        if (rle->run) {
+            for (size_t i = 0; i < n; i++) {
+                dst[i] = rle->run_px;
+            }
+        } else {
+            if (n > (size_t) (rle->end - rle->src) / 2) {
+                n = (rle->end - rle->src) / 2;
+            }
+            if (n == 0) {
+                rle->left = 0;
+                return;
+            }
+            for (size_t i = 0; i < n; i++) {
+                dst[i] = rle->src[2 * i] | (rle->src[2 * i + 1] << 8);
+            }
+            rle->src += 2 * n;
+        }
+
+        rle->left -= n;
+        dst += n;
+        pixels -= n;
+    }
+}
+
+static lv_color_t splash_color(uint16_t rgb565)
+{
+    lv_color_t color;
+
+#if (LV_COLOR_DEPTH == 16) && (LV_COLOR_16_SWAP == 0)
+    color.full = rgb565;
+#elif (LV_COLOR_DEPTH == 16)
+    color.full = (rgb565 >> 8) | (rgb565 << 8);
+#else
+    color = lv_color_make((rgb565 >> 8) & 0xF8, (rgb565 >> 3) & 0xFC, (rgb565 << 3) & 0xF8);
+#endif
+
+    return color;
+}
@@ -14,6 +14,8 @@ extern "C"
  *      INCLUDES
  *********************/
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 
 #include "lvgl_spi_conf.h"
 #include "lvgl_tft/disp_driver.h"
@@ -58,7 +60,7 @@ extern "C"
 #elif defined CONFIG_LV_TFT_DISPLAY_CONTROLLER_ILI9341
 #define DISP_BUF_SIZE (CONFIG_LV_HOR_RES_MAX * 40)
 #elif defined CONFIG_LV_TFT_DISPLAY_CONTROLLER_SSD1306
-#if defined(CONFIG_LV_THEME_MONO)
+#if defined(CONFIG_LV_THEME_MONO) && !defined(CONFIG_LV_DISP_MONO_PAGE_PACK)
 #define DISP_BUF_SIZE (CONFIG_LV_HOR_RES_MAX * (CONFIG_LV_VER_RES_MAX / 8))
 #else
 #define DISP_BUF_SIZE (CONFIG_LV_HOR_RES_MAX * CONFIG_LV_VER_RES_MAX)
@@ -98,6 +100,23 @@ extern "C"
     /* Initialize I2C master  */
     bool lvgl_i2c_driver_init(int port, int sda_pin, int scl_pin, int speed);
 
+    /* Allocate two DMA capable draw buffers of DISP_BUF_SIZE lv_color_t each,
+     * so LVGL can render into one while the other one is being flushed.
+     * Returns true on success. */
+    bool lvgl_alloc_draw_buffers(lv_color_t **buf1, lv_color_t **buf2);
+
+    /* Paint a RLE compressed RGB565 image of w x h pixels, centered on a
+     * bg_rgb565 background, straight through disp_driver_flush. Meant to be
+     * called right after lvgl_driver_init, LVGL doesn't need to be initialized.
+     *
+     * The image is a list of little endian 16-bit words: a header word with
+     * bit 15 set is followed by one pixel repeated (header & 0x7FFF) times,
+     * otherwise by (header) literal pixels. Pixels are RGB565, red in the
+     * high bits. Returns false on the e-paper controllers, whose flush needs
+     * a full frame buffer, or if the stripe buffers can't be allocated. */
+    bool lvgl_splash_draw(const uint8_t *rle, size_t rle_size, lv_coord_t w, lv_coord_t h,
+                          uint16_t bg_rgb565);
+
     /**********************
      *      MACROS
      **********************/
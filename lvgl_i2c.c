@@ -0,0 +1,98 @@
+/**
+ * @file lvgl_i2c.c
+ *
+ */
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include "lvgl_i2c.h"
+
+#include "freertos/FreeRTOS.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+
+#define I2C_TIMEOUT_MS  100
+
+/* Start, address, register and data make up the write, the read adds a
+ * repeated start, the address again and the NACKed last byte */
+#define I2C_WRITE_LINK_SIZE I2C_LINK_RECOMMENDED_SIZE(1)
+#define I2C_READ_LINK_SIZE  I2C_LINK_RECOMMENDED_SIZE(2)
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+
+/**********************
+ *      MACROS
+ **********************/
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+/* The command links are built in a buffer on the caller's stack, so the
+ * display flush and the touch read don't touch the heap and can run from
+ * different tasks. The data is queued by reference, not byte by byte */
+esp_err_t lvgl_i2c_write(i2c_port_t port, uint8_t addr, uint8_t reg, const void *data, size_t len)
+{
+    uint8_t link_buf[I2C_WRITE_LINK_SIZE];
+    esp_err_t err;
+
+    i2c_cmd_handle_t cmd = i2c_cmd_link_create_static(link_buf, sizeof(link_buf));
+    assert(NULL != cmd);
+
+    i2c_master_start(cmd);
+    i2c_master_write_byte(cmd, (addr << 1) | I2C_MASTER_WRITE, true);
+    i2c_master_write_byte(cmd, reg, true);
+
+    if (len > 0) {
+        i2c_master_write(cmd, (const uint8_t *) data, len, true);
+    }
+
+    i2c_master_stop(cmd);
+
+    err = i2c_master_cmd_begin(port, cmd, pdMS_TO_TICKS(I2C_TIMEOUT_MS));
+    i2c_cmd_link_delete_static(cmd);
+
+    return err;
+}
+
+esp_err_t lvgl_i2c_read(i2c_port_t port, uint8_t addr, uint8_t reg, void *data, size_t len)
+{
+    uint8_t link_buf[I2C_READ_LINK_SIZE];
+    esp_err_t err;
+
+    assert(len > 0);
+
+    i2c_cmd_handle_t cmd = i2c_cmd_link_create_static(link_buf, sizeof(link_buf));
+    assert(NULL != cmd);
+
+    i2c_master_start(cmd);
+    i2c_master_write_byte(cmd, (addr << 1) | I2C_MASTER_WRITE, true);
+    i2c_master_write_byte(cmd, reg, true);
+
+    i2c_master_start(cmd);
+    i2c_master_write_byte(cmd, (addr << 1) | I2C_MASTER_READ, true);
+    i2c_master_read(cmd, (uint8_t *) data, len, I2C_MASTER_LAST_NACK);
+    i2c_master_stop(cmd);
+
+    err = i2c_master_cmd_begin(port, cmd, pdMS_TO_TICKS(I2C_TIMEOUT_MS));
+    i2c_cmd_link_delete_static(cmd);
+
+    return err;
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
@@ -0,0 +1,48 @@
+/**
+ * @file lvgl_i2c.h
+ */
+
+#ifndef LVGL_I2C_H
+#define LVGL_I2C_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "driver/i2c.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+
+/**********************
+ * GLOBAL PROTOTYPES
+ **********************/
+
+/* Write reg followed by len bytes of data to the device at addr in a single
+ * transaction. reg is the register address or, on displays, the control byte */
+esp_err_t lvgl_i2c_write(i2c_port_t port, uint8_t addr, uint8_t reg, const void *data, size_t len);
+
+/* Read len bytes starting at register reg of the device at addr */
+esp_err_t lvgl_i2c_read(i2c_port_t port, uint8_t addr, uint8_t reg, void *data, size_t len);
+
+/**********************
+ *      MACROS
+ **********************/
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /*LVGL_I2C_H*/
@@ -42,6 +42,11 @@ extern "C" {
 #else
     #define DISP_SPI_CS (-1)
 #endif
+#if defined (CONFIG_LV_DISPLAY_USE_DC)
+    #define DISP_SPI_DC CONFIG_LV_DISP_PIN_DC
+#else
+    #define DISP_SPI_DC (-1)
+#endif
 
 /* Define TOUCHPAD PINS when selecting a touch controller */
 #if !defined (CONFIG_LV_TOUCH_CONTROLLER_NONE)
@@ -152,6 +157,8 @@ extern "C" {
 #define SPI_TFT_CLOCK_SPEED_HZ  (26*1000*1000)
 #elif defined (CONFIG_LV_TFT_DISPLAY_CONTROLLER_SH1107)
 #define SPI_TFT_CLOCK_SPEED_HZ  (8*1000*1000)
+#elif defined (CONFIG_LV_TFT_DISPLAY_CONTROLLER_SSD1306)
+#define SPI_TFT_CLOCK_SPEED_HZ  (10*1000*1000)
 #elif defined (CONFIG_LV_TFT_DISPLAY_CONTROLLER_ILI9481)
 #define SPI_TFT_CLOCK_SPEED_HZ  (16*1000*1000)
 #elif defined (CONFIG_LV_TFT_DISPLAY_CONTROLLER_ILI9486)
@@ -169,6 +176,10 @@ extern "C" {
 #endif
 
 
+/* Clock of the transactions sent with DISP_SPI_CLOCK_SLOW, e.g. register
+ * access before the display controller clocks are set up */
+#define SPI_TFT_SLOW_CLOCK_SPEED_HZ (1*1000*1000)
+
 #if defined (CONFIG_LV_TFT_DISPLAY_CONTROLLER_ST7789)
 #define SPI_TFT_SPI_MODE    (2)
 #else
@@ -137,6 +137,9 @@ uint8_t SPIDummyReadBits = 0;					// Dummy bits for reading in DIO/QIO modes
 #define WAIT_SPI() \
 	disp_wait_for_pending_transactions();
 
+// Register writes queued by EVE_memWrite_burst in one batch
+#define MEM_WRITE_BURST_MAX 16
+
 
 
 void DELAY_MS(uint16_t ms)
@@ -265,6 +268,30 @@ void EVE_memWrite32(uint32_t ftAddress, uint32_t ftData32)
 }
 
 
+// write a list of registers, queued as one batch and completed before returning like EVE_memWriteXX
+void EVE_memWrite_burst(const EVE_memWrite_t *writes, uint16_t count)
+{
+	disp_spi_segment_t segs[MEM_WRITE_BURST_MAX];
+
+	while(count > 0)
+	{
+		uint16_t n = (count > MEM_WRITE_BURST_MAX ? MEM_WRITE_BURST_MAX : count);
+
+		for(uint16_t i = 0; i < n; i++)
+		{
+			segs[i].data = (const uint8_t*)&writes[i].ftData;	/* little endian, the low bytes come first */
+			segs[i].length = writes[i].size;
+			segs[i].flags = (disp_spi_send_flag_t)(DISP_SPI_ADDRESS_24 | SPIInherentSendFlags);
+			segs[i].addr = (writes[i].ftAddress | MEM_WRITE_24);
+		}
+
+		disp_spi_transaction_batch(segs, n, DISP_SPI_SEND_SYNCHRONOUS);
+		writes += n;
+		count -= n;
+	}
+}
+
+
 // write to EVE memory via SPI memory-mapped protocol using queued SPI transactions (i.e. DMA)
 // Note: data should be in DMA-capable memory!
 void EVE_memWrite_buffer(uint32_t ftAddress, const uint8_t *data, uint32_t len, bool LvGL_Flush)
@@ -954,36 +981,39 @@ uint8_t EVE_init(void)
 #endif
 
 	/* Initialize Display */
-	EVE_memWrite16(REG_HSIZE,   EVE_HSIZE);   /* active display width */
-	EVE_memWrite16(REG_HCYCLE,  EVE_HCYCLE);  /* total number of clocks per line, incl front/back porch */
-	EVE_memWrite16(REG_HOFFSET, EVE_HOFFSET); /* start of active line */
-	EVE_memWrite16(REG_HSYNC0,  EVE_HSYNC0);  /* start of horizontal sync pulse */
-	EVE_memWrite16(REG_HSYNC1,  EVE_HSYNC1);  /* end of horizontal sync pulse */
-	EVE_memWrite16(REG_VSIZE,   EVE_VSIZE);   /* active display height */
-	EVE_memWrite16(REG_VCYCLE,  EVE_VCYCLE);  /* total number of lines per screen, including pre/post */
-	EVE_memWrite16(REG_VOFFSET, EVE_VOFFSET); /* start of active screen */
-	EVE_memWrite16(REG_VSYNC0,  EVE_VSYNC0);  /* start of vertical sync pulse */
-	EVE_memWrite16(REG_VSYNC1,  EVE_VSYNC1);  /* end of vertical sync pulse */
-	EVE_memWrite8(REG_SWIZZLE,  EVE_SWIZZLE); /* FT8xx output to LCD - pin order */
-	EVE_memWrite8(REG_PCLK_POL, EVE_PCLKPOL); /* LCD data is clocked in on this PCLK edge */
-	EVE_memWrite8(REG_CSPREAD,	EVE_CSPREAD); /* helps with noise, when set to 1 fewer signals are changed simultaneously, reset-default: 1 */
-
-	/* do not set PCLK yet - wait for just after the first display list */
-
-	/* configure Touch */
-	EVE_memWrite8(REG_TOUCH_MODE, EVE_TMODE_CONTINUOUS); /* enable touch */
-	EVE_memWrite16(REG_TOUCH_RZTHRESH, EVE_TOUCH_RZTHRESH);	/* eliminate any false touches */
-
-	/* disable Audio for now */
-	EVE_memWrite8(REG_VOL_PB, 0x00); /* turn recorded audio volume down */
-	EVE_memWrite8(REG_VOL_SOUND, 0x00); /* turn synthesizer volume off */
-	EVE_memWrite16(REG_SOUND, 0x6000); /* set synthesizer to mute */
-
-	/* write a basic display-list to get things started */
-	EVE_memWrite32(EVE_RAM_DL, DL_CLEAR_RGB);
-	EVE_memWrite32(EVE_RAM_DL + 4, (DL_CLEAR | CLR_COL | CLR_STN | CLR_TAG));
-	EVE_memWrite32(EVE_RAM_DL + 8, DL_DISPLAY);	/* end of display list */
-	EVE_memWrite32(REG_DLSWAP, EVE_DLSWAP_FRAME);
+	const EVE_memWrite_t init_regs[] = {
+		{REG_HSIZE,   EVE_HSIZE,   2}, /* active display width */
+		{REG_HCYCLE,  EVE_HCYCLE,  2}, /* total number of clocks per line, incl front/back porch */
+		{REG_HOFFSET, EVE_HOFFSET, 2}, /* start of active line */
+		{REG_HSYNC0,  EVE_HSYNC0,  2}, /* start of horizontal sync pulse */
+		{REG_HSYNC1,  EVE_HSYNC1,  2}, /* end of horizontal sync pulse */
+		{REG_VSIZE,   EVE_VSIZE,   2}, /* active display height */
+		{REG_VCYCLE,  EVE_VCYCLE,  2}, /* total number of lines per screen, including pre/post */
+		{REG_VOFFSET, EVE_VOFFSET, 2}, /* start of active screen */
+		{REG_VSYNC0,  EVE_VSYNC0,  2}, /* start of vertical sync pulse */
+		{REG_VSYNC1,  EVE_VSYNC1,  2}, /* end of vertical sync pulse */
+		{REG_SWIZZLE, EVE_SWIZZLE, 1}, /* FT8xx output to LCD - pin order */
+		{REG_PCLK_POL, EVE_PCLKPOL, 1}, /* LCD data is clocked in on this PCLK edge */
+		{REG_CSPREAD, EVE_CSPREAD, 1}, /* helps with noise, when set to 1 fewer signals are changed simultaneously, reset-default: 1 */
+
+		/* do not set PCLK yet - wait for just after the first display list */
+
+		/* configure Touch */
+		{REG_TOUCH_MODE, EVE_TMODE_CONTINUOUS, 1}, /* enable touch */
+		{REG_TOUCH_RZTHRESH, EVE_TOUCH_RZTHRESH, 2}, /* eliminate any false touches */
+
+		/* disable Audio for now */
+		{REG_VOL_PB, 0x00, 1}, /* turn recorded audio volume down */
+		{REG_VOL_SOUND, 0x00, 1}, /* turn synthesizer volume off */
+		{REG_SOUND, 0x6000, 2}, /* set synthesizer to mute */
+
+		/* write a basic display-list to get things started */
+		{EVE_RAM_DL, DL_CLEAR_RGB, 4},
+		{EVE_RAM_DL + 4, (DL_CLEAR | CLR_COL | CLR_STN | CLR_TAG), 4},
+		{EVE_RAM_DL + 8, DL_DISPLAY, 4}, /* end of display list */
+		{REG_DLSWAP, EVE_DLSWAP_FRAME, 4},
+	};
+	EVE_memWrite_burst(init_regs, sizeof(init_regs) / sizeof(init_regs[0]));
 
 	/* nothing is being displayed yet... the pixel clock is still 0x00 */
 	EVE_memWrite8(REG_GPIO, 0x80); /* enable the DISP signal to the LCD panel, it is set to output in REG_GPIO_DIR by default */
@@ -2303,11 +2333,14 @@ void EVE_calibrate_manual(uint16_t height)
 	tmp = ((touchY[0] * (((touchX[2] * displayY[1]) - (touchX[1] * displayY[2])))) + (touchY[1] * (((touchX[0] * displayY[2]) - (touchX[2] * displayY[0])))) + (touchY[2] * (((touchX[1] * displayY[0]) - (touchX[0] * displayY[1])))));
 	TransMatrix[5] = ((int64_t)tmp << 16) / k;
 
-	EVE_memWrite32(REG_TOUCH_TRANSFORM_A, TransMatrix[0]);
-	EVE_memWrite32(REG_TOUCH_TRANSFORM_B, TransMatrix[1]);
-	EVE_memWrite32(REG_TOUCH_TRANSFORM_C, TransMatrix[2]);
-	EVE_memWrite32(REG_TOUCH_TRANSFORM_D, TransMatrix[3]);
-	EVE_memWrite32(REG_TOUCH_TRANSFORM_E, TransMatrix[4]);
-	EVE_memWrite32(REG_TOUCH_TRANSFORM_F, TransMatrix[5]);
+	const EVE_memWrite_t transform_regs[] = {
+		{REG_TOUCH_TRANSFORM_A, TransMatrix[0], 4},
+		{REG_TOUCH_TRANSFORM_B, TransMatrix[1], 4},
+		{REG_TOUCH_TRANSFORM_C, TransMatrix[2], 4},
+		{REG_TOUCH_TRANSFORM_D, TransMatrix[3], 4},
+		{REG_TOUCH_TRANSFORM_E, TransMatrix[4], 4},
+		{REG_TOUCH_TRANSFORM_F, TransMatrix[5], 4},
+	};
+	EVE_memWrite_burst(transform_regs, sizeof(transform_regs) / sizeof(transform_regs[0]));
 }
 #endif // FT81X_FULL
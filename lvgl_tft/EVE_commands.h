@@ -54,6 +54,15 @@ void EVE_memWrite8(uint32_t ftAddress, uint8_t ftData8);
 void EVE_memWrite16(uint32_t ftAddress, uint16_t ftData16);
 void EVE_memWrite32(uint32_t ftAddress, uint32_t ftData32);
 
+/* one register write of a burst, size is 1, 2 or 4 bytes */
+typedef struct {
+	uint32_t ftAddress;
+	uint32_t ftData;
+	uint8_t size;
+} EVE_memWrite_t;
+
+void EVE_memWrite_burst(const EVE_memWrite_t *writes, uint16_t count);
+
 void EVE_memWrite_buffer(uint32_t ftAddress, const uint8_t *data, uint32_t len, bool LvGL_Flush);
 
 uint8_t EVE_busy(void);
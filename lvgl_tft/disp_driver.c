@@ -5,6 +5,33 @@
 #include "disp_driver.h"
 #include "disp_spi.h"
 
+#if defined (CONFIG_LV_DISP_ASYNC_FLUSH) && defined (DISP_DRIVER_BLOCKING_FLUSH)
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+#define DISP_FLUSH_TASK
+#define DISP_FLUSH_TASK_STACK_SIZE  (3 * 1024)
+
+typedef struct {
+    lv_disp_drv_t * drv;
+    lv_area_t area;
+    lv_color_t * color_map;
+    SemaphoreHandle_t done;     /* given once the job ran, NULL for LVGL flushes */
+} disp_flush_job_t;
+
+static QueueHandle_t flush_queue;
+
+static void disp_flush_task(void * arg);
+#endif
+
+static void disp_driver_do_flush(lv_disp_drv_t * drv, const lv_area_t * area, lv_color_t * color_map);
+
+#if defined (DISP_DRIVER_HW_SCROLL)
+static bool scroll_ready;
+#endif
+
 void disp_driver_init(void)
 {
 #if defined CONFIG_LV_TFT_DISPLAY_CONTROLLER_NV6001
@@ -42,10 +69,63 @@ void disp_driver_init(void)
 #elif defined CONFIG_LV_TFT_DISPLAY_CONTROLLER_UC8151D
    uc8151d_init();
 #endif
+
+#if defined (DISP_FLUSH_TASK)
+    /* LVGL won't start a new flush before the previous one is ready, a single entry is enough */
+    flush_queue = xQueueCreate(1, sizeof(disp_flush_job_t));
+    assert(flush_queue != NULL);
+
+    BaseType_t ret = xTaskCreate(disp_flush_task, "disp_flush", DISP_FLUSH_TASK_STACK_SIZE,
+        NULL, CONFIG_LV_DISP_ASYNC_FLUSH_TASK_PRIORITY, NULL);
+    assert(ret == pdPASS);
+#endif
 }
 
 void disp_driver_flush(lv_disp_drv_t * drv, const lv_area_t * area, lv_color_t * color_map)
 {
+#if defined (DISP_FLUSH_TASK)
+    /* Hand the area over to the flush task, the driver calls lv_disp_flush_ready once done */
+    disp_flush_job_t job = {
+        .drv = drv,
+        .area = *area,
+        .color_map = color_map,
+        .done = NULL,
+    };
+
+    xQueueSend(flush_queue, &job, portMAX_DELAY);
+#else
+    disp_driver_do_flush(drv, area, color_map);
+#endif
+}
+
+void disp_driver_wait_flush(void)
+{
+#if defined (DISP_FLUSH_TASK)
+    /* The jobs run in order and the flushes block, so an empty job carrying
+     * the caller's semaphore completes after the ones queued before it */
+    StaticSemaphore_t done_buf;
+    disp_flush_job_t fence = {
+        .drv = NULL,
+        .done = xSemaphoreCreateBinaryStatic(&done_buf),
+    };
+
+    xQueueSend(flush_queue, &fence, portMAX_DELAY);
+    xSemaphoreTake(fence.done, portMAX_DELAY);
+    vSemaphoreDelete(fence.done);
+#endif
+
+#if defined (CONFIG_LV_TFT_DISPLAY_PROTOCOL_SPI)
+    /* the queued transactions signal the flushes as they complete */
+    disp_wait_for_pending_transactions();
+#endif
+}
+
+static void disp_driver_do_flush(lv_disp_drv_t * drv, const lv_area_t * area, lv_color_t * color_map)
+{
+#if defined (CONFIG_LV_TFT_DISPLAY_PROTOCOL_SPI)
+    disp_spi_set_disp_drv(drv);
+#endif
+
 #if defined CONFIG_LV_TFT_DISPLAY_CONTROLLER_NV6001
     nv6001_flush(drv, area, color_map);
 #elif defined CONFIG_LV_TFT_DISPLAY_CONTROLLER_ILI9341
@@ -85,7 +165,9 @@ void disp_driver_flush(lv_disp_drv_t * drv, const lv_area_t * area, lv_color_t *
 
 void disp_driver_rounder(lv_disp_drv_t * disp_drv, lv_area_t * area)
 {
-#if defined CONFIG_LV_TFT_DISPLAY_CONTROLLER_SSD1306
+#if defined CONFIG_LV_TFT_DISPLAY_CONTROLLER_NV6001
+    nv6001_rounder(disp_drv, area);
+#elif defined CONFIG_LV_TFT_DISPLAY_CONTROLLER_SSD1306
     ssd1306_rounder(disp_drv, area);
 #elif defined CONFIG_LV_TFT_DISPLAY_CONTROLLER_SH1107
     sh1107_rounder(disp_drv, area);
@@ -113,3 +195,86 @@ void disp_driver_set_px(lv_disp_drv_t * disp_drv, uint8_t * buf, lv_coord_t buf_
     uc8151d_lv_set_fb_cb(disp_drv, buf, buf_w, x, y, color, opa);
 #endif
 }
+
+bool disp_driver_scroll_init(lv_coord_t top_fixed, lv_coord_t bottom_fixed)
+{
+#if defined CONFIG_LV_TFT_DISPLAY_CONTROLLER_ILI9341
+    scroll_ready = ili9341_scroll_init(top_fixed, bottom_fixed);
+#elif defined CONFIG_LV_TFT_DISPLAY_CONTROLLER_ST7789
+    scroll_ready = st7789_scroll_init(top_fixed, bottom_fixed);
+#elif defined CONFIG_LV_TFT_DISPLAY_CONTROLLER_ILI9488
+    scroll_ready = ili9488_scroll_init(top_fixed, bottom_fixed);
+#else
+    (void) top_fixed;
+    (void) bottom_fixed;
+#endif
+
+#if defined (DISP_DRIVER_HW_SCROLL)
+    return scroll_ready;
+#else
+    return false;
+#endif
+}
+
+bool disp_driver_scroll(lv_coord_t dy, lv_area_t * exposed)
+{
+#if defined (DISP_DRIVER_HW_SCROLL)
+    if (!scroll_ready) {
+        return false;
+    }
+#endif
+
+#if defined CONFIG_LV_TFT_DISPLAY_CONTROLLER_ILI9341
+    ili9341_scroll(dy, exposed);
+#elif defined CONFIG_LV_TFT_DISPLAY_CONTROLLER_ST7789
+    st7789_scroll(dy, exposed);
+#elif defined CONFIG_LV_TFT_DISPLAY_CONTROLLER_ILI9488
+    ili9488_scroll(dy, exposed);
+#else
+    (void) dy;
+    (void) exposed;
+    return false;
+#endif
+
+#if defined (DISP_DRIVER_HW_SCROLL)
+    return true;
+#endif
+}
+
+void disp_driver_scroll_stop(void)
+{
+#if defined (DISP_DRIVER_HW_SCROLL)
+    if (!scroll_ready) {
+        return;
+    }
+    scroll_ready = false;
+#endif
+
+#if defined CONFIG_LV_TFT_DISPLAY_CONTROLLER_ILI9341
+    ili9341_scroll_stop();
+#elif defined CONFIG_LV_TFT_DISPLAY_CONTROLLER_ST7789
+    st7789_scroll_stop();
+#elif defined CONFIG_LV_TFT_DISPLAY_CONTROLLER_ILI9488
+    ili9488_scroll_stop();
+#endif
+}
+
+#if defined (DISP_FLUSH_TASK)
+static void disp_flush_task(void * arg)
+{
+    disp_flush_job_t job;
+
+    (void) arg;
+
+    for (;;) {
+        if (xQueueReceive(flush_queue, &job, portMAX_DELAY) == pdTRUE) {
+            if (job.drv) {
+                disp_driver_do_flush(job.drv, &job.area, job.color_map);
+            }
+            if (job.done) {
+                xSemaphoreGive(job.done);
+            }
+        }
+    }
+}
+#endif
@@ -57,6 +57,40 @@ extern "C" {
 /*********************
  *      DEFINES
  *********************/
+/* Controllers whose flush blocks until the transfer is done */
+#if defined CONFIG_LV_TFT_DISPLAY_CONTROLLER_NV6001   || \
+    (defined CONFIG_LV_TFT_DISPLAY_CONTROLLER_SSD1306 && defined CONFIG_LV_TFT_DISPLAY_PROTOCOL_I2C) || \
+    defined CONFIG_LV_TFT_DISPLAY_CONTROLLER_IL3820   || \
+    defined CONFIG_LV_TFT_DISPLAY_CONTROLLER_JD79653A || \
+    defined CONFIG_LV_TFT_DISPLAY_CONTROLLER_UC8151D
+#define DISP_DRIVER_BLOCKING_FLUSH
+#endif
+
+/* Controllers packing the pixels themselves through disp_driver_set_px,
+   the OLEDs can pack them in the flush instead */
+#if (!defined CONFIG_LV_DISP_MONO_PAGE_PACK && \
+     (defined CONFIG_LV_TFT_DISPLAY_CONTROLLER_SSD1306 || \
+      defined CONFIG_LV_TFT_DISPLAY_CONTROLLER_SH1107)) || \
+    defined CONFIG_LV_TFT_DISPLAY_CONTROLLER_IL3820   || \
+    defined CONFIG_LV_TFT_DISPLAY_CONTROLLER_JD79653A || \
+    defined CONFIG_LV_TFT_DISPLAY_CONTROLLER_UC8151D
+#define DISP_DRIVER_SET_PX
+#endif
+
+/* E-paper controllers, their flush refreshes the whole panel out of a full
+   frame buffer whatever the area */
+#if defined CONFIG_LV_TFT_DISPLAY_CONTROLLER_IL3820   || \
+    defined CONFIG_LV_TFT_DISPLAY_CONTROLLER_JD79653A || \
+    defined CONFIG_LV_TFT_DISPLAY_CONTROLLER_UC8151D
+#define DISP_DRIVER_EPAPER
+#endif
+
+/* Controllers with hardware vertical scrolling */
+#if defined CONFIG_LV_TFT_DISPLAY_CONTROLLER_ILI9341  || \
+    defined CONFIG_LV_TFT_DISPLAY_CONTROLLER_ST7789   || \
+    defined CONFIG_LV_TFT_DISPLAY_CONTROLLER_ILI9488
+#define DISP_DRIVER_HW_SCROLL
+#endif
 
 /**********************
  *      TYPEDEFS
@@ -72,13 +106,29 @@ void disp_driver_init(void);
 /* Display flush callback */
 void disp_driver_flush(lv_disp_drv_t * drv, const lv_area_t * area, lv_color_t * color_map);
 
-/* Display rounder callback, used with monochrome dispays */
+/* Wait until the areas handed to disp_driver_flush are on the panel and
+   their buffers can be reused, for code flushing without LVGL */
+void disp_driver_wait_flush(void);
+
+/* Display rounder callback, used with monochrome dispays and NV6001 */
 void disp_driver_rounder(lv_disp_drv_t * disp_drv, lv_area_t * area);
 
 /* Display set_px callback, used with monochrome dispays */
 void disp_driver_set_px(lv_disp_drv_t * disp_drv, uint8_t * buf, lv_coord_t buf_w, lv_coord_t x, lv_coord_t y,
     lv_color_t color, lv_opa_t opa);
 
+/* Set up hardware vertical scrolling between the fixed top and bottom rows,
+   false if the controller or the orientation don't support it */
+bool disp_driver_scroll_init(lv_coord_t top_fixed, lv_coord_t bottom_fixed);
+
+/* Move the scrolled rows up by dy (down if negative) in the controller and
+   set exposed to the rows to invalidate, instead of redrawing them all.
+   false if scrolling isn't set up, the whole area has to be redrawn then. */
+bool disp_driver_scroll(lv_coord_t dy, lv_area_t * exposed);
+
+/* Stop scrolling, the whole screen has to be redrawn */
+void disp_driver_scroll_stop(void);
+
 /**********************
  *      MACROS
  **********************/
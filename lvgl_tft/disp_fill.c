@@ -0,0 +1,112 @@
+/**
+ * @file disp_fill.c
+ *
+ */
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include "disp_fill.h"
+#include "disp_spi.h"
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+
+#include <string.h>
+
+/*********************
+ *      DEFINES
+ *********************/
+#define TAG "disp_fill"
+
+#define LINE_BYTES      (DISP_FILL_LINE_PIXELS * sizeof(uint16_t))
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+static bool is_uniform(const uint16_t *px, size_t pixels);
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+static uint16_t *line_buf;
+static uint16_t line_color;
+static uint32_t line_fence;
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+void disp_fill_init(void)
+{
+    if (line_buf != NULL) {
+        return;
+    }
+
+    line_buf = (uint16_t *) heap_caps_malloc(LINE_BYTES, MALLOC_CAP_DMA);
+    if (line_buf == NULL) {
+        ESP_LOGW(TAG, "No DMA memory for the line buffer, solid fills disabled");
+        return;
+    }
+
+    line_color = 0;
+    memset(line_buf, 0, LINE_BYTES);
+    line_fence = disp_spi_fence();
+}
+
+bool disp_fill_send_pixels(lv_disp_drv_t *drv, const lv_color_t *color_map, size_t pixels)
+{
+    const uint16_t *px = (const uint16_t *) color_map;
+
+    /* below a line, reading the area twice costs more than sending it */
+    if (line_buf == NULL || pixels <= DISP_FILL_LINE_PIXELS || !is_uniform(px, pixels)) {
+        return false;
+    }
+
+    if (px[0] != line_color) {
+        /* the line may still be going out for the previous fill */
+        disp_spi_wait_fence(line_fence);
+        line_color = px[0];
+        for (size_t i = 0; i < DISP_FILL_LINE_PIXELS; i++) {
+            line_buf[i] = line_color;
+        }
+    }
+
+    for (; pixels > DISP_FILL_LINE_PIXELS; pixels -= DISP_FILL_LINE_PIXELS) {
+        disp_spi_transaction_stream((const uint8_t *) line_buf, LINE_BYTES,
+            DISP_SPI_SEND_QUEUED | DISP_SPI_DC_DATA, 0);
+    }
+    disp_spi_transaction_stream((const uint8_t *) line_buf, pixels * sizeof(uint16_t),
+        DISP_SPI_SEND_QUEUED | DISP_SPI_DC_DATA, 0);
+    line_fence = disp_spi_fence();
+
+    /* the draw buffer isn't read by the transfers, LVGL can have it back */
+    lv_disp_flush_ready(drv);
+
+    return true;
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+/* Compares two pixels at a time, bails out on the first different one */
+static bool is_uniform(const uint16_t *px, size_t pixels)
+{
+    const uint16_t color = px[0];
+
+    if ((uintptr_t) px & 2) {
+        px++;
+        pixels--;
+    }
+
+    const uint32_t pair = color | ((uint32_t) color << 16);
+    const uint32_t *p = (const uint32_t *) px;
+
+    for (; pixels >= 2; pixels -= 2) {
+        if (*p++ != pair) {
+            return false;
+        }
+    }
+
+    return pixels == 0 || *(const uint16_t *) p == color;
+}
@@ -0,0 +1,47 @@
+/**
+ * @file disp_fill.h
+ *
+ * Solid color areas of RGB565 SPI displays sent out of a line buffer.
+ */
+
+#ifndef DISP_FILL_H
+#define DISP_FILL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef LV_LVGL_H_INCLUDE_SIMPLE
+#include "lvgl.h"
+#else
+#include "lvgl/lvgl.h"
+#endif
+
+/*********************
+ *      DEFINES
+ *********************/
+#define DISP_FILL_LINE_PIXELS   LV_HOR_RES_MAX
+
+/**********************
+ * GLOBAL PROTOTYPES
+ **********************/
+
+/* Allocate the DMA line buffer, without it every area is sent as is */
+void disp_fill_init(void);
+
+/* Called after the memory write command. If all the pixels have the same
+   color they are queued out of the line buffer, the flush is signaled done
+   right away and true is returned. Otherwise nothing is sent. */
+bool disp_fill_send_pixels(lv_disp_drv_t *drv, const lv_color_t *color_map, size_t pixels);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /*DISP_FILL_H*/
@@ -0,0 +1,413 @@
+/**
+ * @file disp_mipi.c
+ *
+ */
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include "disp_mipi.h"
+#include "disp_spi.h"
+#include "disp_fill.h"
+#include "disp_pixconv.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "driver/gpio.h"
+
+#include <assert.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+#define TAG "disp_mipi"
+
+/* Parameters expanded per transaction on 16-bit buses */
+#define WIDE_PARAMS_CHUNK   16
+
+/* Init table entries queued per batch */
+#define INIT_BATCH_CMDS     8
+
+/* Reset timings shared by the ILI and ST controllers */
+#define RESET_PULSE_MS      1
+#define RESET_WAIT_MS       5
+#define SLPOUT_LOCKOUT_MS   120
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+static void send_init_batch(disp_spi_segment_t *segs, size_t *count, bool wait);
+static void send_range(uint8_t cmd, uint16_t start, uint16_t end);
+static void write_pixels(const lv_color_t *color_map, size_t pixels, bool signal_flush);
+static void flush_scrolled(const lv_area_t *area, lv_color_t *color_map);
+static uint16_t scroll_map_row(uint16_t row);
+static void send_scroll_address(void);
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+static const disp_mipi_panel_t *panel;
+static uint8_t madctl;
+
+static int64_t reset_time;
+
+static bool window_valid;
+static uint16_t window_col[2];
+static uint16_t window_page[2];
+
+/* Scroll area in frame memory rows, as VSCRDEF counts them, and in screen rows */
+static bool scroll_on;
+static uint16_t scroll_tfa;
+static uint16_t scroll_vsa;
+static uint16_t scroll_start;
+static lv_coord_t scroll_top;
+static lv_coord_t scroll_bottom;
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+void disp_mipi_init(const disp_mipi_panel_t *p)
+{
+    panel = p;
+    scroll_on = false;
+
+    ESP_LOGI(panel->name, "Initialization.");
+
+    if (panel->init_cmds) {
+        disp_mipi_send_init_cmds(panel->init_cmds);
+    }
+
+    disp_mipi_set_orientation(CONFIG_LV_DISPLAY_ORIENTATION);
+
+    if (panel->inversion != DISP_MIPI_INVERSION_BY_TABLE) {
+        disp_mipi_send_cmd(panel->inversion == DISP_MIPI_INVERSION_ON ?
+            DISP_MIPI_INVON : DISP_MIPI_INVOFF);
+    }
+
+    disp_mipi_invalidate_window();
+
+    if (panel->bytes_per_pixel == 2) {
+        disp_fill_init();
+    }
+}
+
+void disp_mipi_flush(lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t *color_map)
+{
+    size_t size = lv_area_get_width(area) * lv_area_get_height(area);
+
+    if (scroll_on) {
+        flush_scrolled(area, color_map);
+        return;
+    }
+
+    disp_mipi_set_window(area->x1 + panel->x_offset, area->y1 + panel->y_offset,
+        area->x2 + panel->x_offset, area->y2 + panel->y_offset);
+
+    if (panel->bytes_per_pixel == 2 && !panel->write_pixels &&
+        disp_fill_send_pixels(drv, color_map, size)) {
+        return;
+    }
+
+    write_pixels(color_map, size, true);
+}
+
+void disp_mipi_set_orientation(uint8_t orientation)
+{
+    const char *orientation_str[] = {
+        "PORTRAIT", "PORTRAIT_INVERTED", "LANDSCAPE", "LANDSCAPE_INVERTED"
+    };
+
+    assert(orientation < 4);
+
+    ESP_LOGI(panel->name, "Display orientation: %s", orientation_str[orientation]);
+    ESP_LOGI(panel->name, "0x36 command value: 0x%02X", panel->madctl[orientation]);
+
+    madctl = panel->madctl[orientation];
+
+    disp_mipi_send_cmd(DISP_MIPI_MADCTL);
+    disp_mipi_send_params(&panel->madctl[orientation], 1);
+}
+
+void disp_mipi_reset(int rst_gpio)
+{
+    gpio_set_level(rst_gpio, 0);
+    disp_mipi_delay_ms(RESET_PULSE_MS);
+    gpio_set_level(rst_gpio, 1);
+    reset_time = esp_timer_get_time();
+    disp_mipi_delay_ms(RESET_WAIT_MS);
+}
+
+void disp_mipi_soft_reset(void)
+{
+    disp_mipi_send_cmd(DISP_MIPI_SWRESET);
+    disp_wait_for_pending_transactions();
+    reset_time = esp_timer_get_time();
+    disp_mipi_delay_ms(RESET_WAIT_MS);
+}
+
+void disp_mipi_send_init_cmds(const disp_mipi_init_cmd_t *cmds)
+{
+    disp_spi_segment_t segs[INIT_BATCH_CMDS * 2];
+    uint8_t wide[INIT_BATCH_CMDS][2 + 2 * sizeof(cmds->data)];
+    bool wide_bus = panel && panel->wide_bus;
+    size_t count = 0;
+    size_t step_cmds = 0;
+    uint32_t waited_ms = 0;
+    int64_t start = esp_timer_get_time();
+    int64_t step = start;
+
+    for (; cmds->databytes != DISP_MIPI_INIT_END; cmds++) {
+        size_t length = cmds->databytes;
+
+        assert(length <= sizeof(cmds->data));
+
+        if (cmds->cmd == DISP_MIPI_SLPOUT) {
+            int64_t lockout = reset_time + SLPOUT_LOCKOUT_MS * 1000 - esp_timer_get_time();
+
+            if (lockout > 0) {
+                send_init_batch(segs, &count, true);
+                disp_mipi_delay_ms((lockout + 999) / 1000);
+                waited_ms += (lockout + 999) / 1000;
+            }
+        }
+
+        /* the segments are short enough to be copied by disp_spi, neither
+           the tables in flash nor the stack buffers are read by the DMA */
+        if (wide_bus) {
+            uint8_t *buf = wide[count / 2];
+            buf[0] = 0x00;
+            buf[1] = cmds->cmd;
+            disp_pixconv_u8_to_be16(buf + 2, cmds->data, length);
+            segs[count++] = (disp_spi_segment_t) {buf, 2, DISP_SPI_DC_CMD, 0};
+            segs[count++] = (disp_spi_segment_t) {buf + 2, length * 2, DISP_SPI_DC_DATA, 0};
+        } else {
+            segs[count++] = (disp_spi_segment_t) {&cmds->cmd, 1, DISP_SPI_DC_CMD, 0};
+            segs[count++] = (disp_spi_segment_t) {cmds->data, length, DISP_SPI_DC_DATA, 0};
+        }
+        step_cmds++;
+
+        if (cmds->delay_ms > 0) {
+            send_init_batch(segs, &count, true);
+            ESP_LOGD(TAG, "%u commands sent in %d us, waiting %u ms",
+                (unsigned) step_cmds, (int) (esp_timer_get_time() - step), cmds->delay_ms);
+            disp_mipi_delay_ms(cmds->delay_ms);
+            waited_ms += cmds->delay_ms;
+            step = esp_timer_get_time();
+            step_cmds = 0;
+        } else if (count == INIT_BATCH_CMDS * 2) {
+            send_init_batch(segs, &count, false);
+        }
+    }
+
+    send_init_batch(segs, &count, true);
+    ESP_LOGD(TAG, "%u commands sent in %d us", (unsigned) step_cmds, (int) (esp_timer_get_time() - step));
+    ESP_LOGI(TAG, "Init sequence sent in %d ms, %u ms of it waiting",
+        (int) ((esp_timer_get_time() - start) / 1000), (unsigned) waited_ms);
+}
+
+void disp_mipi_delay_ms(uint32_t ms)
+{
+    vTaskDelay((ms + portTICK_PERIOD_MS - 1) / portTICK_PERIOD_MS);
+}
+
+void disp_mipi_send_cmd(uint8_t cmd)
+{
+    if (panel && panel->wide_bus) {
+        uint8_t cmd16[] = {0x00, cmd};
+        disp_spi_transaction(cmd16, sizeof(cmd16),
+            DISP_SPI_SEND_QUEUED | DISP_SPI_DC_CMD, NULL, 0, 0);
+    } else {
+        disp_spi_send_cmd(cmd);
+    }
+}
+
+void disp_mipi_send_params(const uint8_t *data, size_t length)
+{
+    if (!(panel && panel->wide_bus)) {
+        disp_spi_send_params(data, length);
+        return;
+    }
+
+    /* short enough to be copied by disp_spi, the stack buffer can go */
+    uint8_t data16[WIDE_PARAMS_CHUNK * 2];
+
+    while (length > 0) {
+        size_t n = length < WIDE_PARAMS_CHUNK ? length : WIDE_PARAMS_CHUNK;
+        disp_pixconv_u8_to_be16(data16, data, n);
+        disp_spi_send_params(data16, n * 2);
+        data += n;
+        length -= n;
+    }
+}
+
+void disp_mipi_set_window(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2)
+{
+    /* LVGL mostly flushes horizontal stripes, only the pages change */
+    if (!window_valid || window_col[0] != x1 || window_col[1] != x2) {
+        send_range(DISP_MIPI_CASET, x1, x2);
+        window_col[0] = x1;
+        window_col[1] = x2;
+    }
+
+    if (!window_valid || window_page[0] != y1 || window_page[1] != y2) {
+        send_range(DISP_MIPI_RASET, y1, y2);
+        window_page[0] = y1;
+        window_page[1] = y2;
+    }
+
+    window_valid = true;
+    disp_mipi_send_cmd(DISP_MIPI_RAMWR);
+}
+
+bool disp_mipi_scroll_init(uint16_t top_fixed, uint16_t bottom_fixed)
+{
+    /* VSCRDEF works along the gate lines, which are columns with MV set */
+    if (panel->memory_lines == 0 || (madctl & DISP_MIPI_MADCTL_MV)) {
+        ESP_LOGW(panel->name, "No vertical scrolling in this orientation");
+        return false;
+    }
+
+    assert(top_fixed + bottom_fixed < LV_VER_RES_MAX);
+
+    uint16_t first = top_fixed + panel->y_offset;
+    uint16_t last = LV_VER_RES_MAX - 1 - bottom_fixed + panel->y_offset;
+
+    assert(last < panel->memory_lines);
+
+    /* the fixed areas are counted from the first gate line, MY flips them */
+    scroll_vsa = last - first + 1;
+    scroll_tfa = (madctl & DISP_MIPI_MADCTL_MY) ? panel->memory_lines - 1 - last : first;
+    scroll_start = 0;
+    scroll_top = top_fixed;
+    scroll_bottom = LV_VER_RES_MAX - 1 - bottom_fixed;
+
+    uint16_t bfa = panel->memory_lines - scroll_tfa - scroll_vsa;
+    uint8_t data[] = {
+        (scroll_tfa >> 8) & 0xFF, scroll_tfa & 0xFF,
+        (scroll_vsa >> 8) & 0xFF, scroll_vsa & 0xFF,
+        (bfa >> 8) & 0xFF, bfa & 0xFF,
+    };
+
+    disp_mipi_send_cmd(DISP_MIPI_VSCRDEF);
+    disp_mipi_send_params(data, sizeof(data));
+    send_scroll_address();
+
+    scroll_on = true;
+    ESP_LOGI(panel->name, "Vertical scrolling of rows %d to %d", scroll_top, scroll_bottom);
+
+    return true;
+}
+
+void disp_mipi_scroll(lv_coord_t dy, lv_area_t *exposed)
+{
+    assert(scroll_on);
+
+    int32_t shift = (madctl & DISP_MIPI_MADCTL_MY) ? -dy : dy;
+    lv_coord_t rows = dy < 0 ? -dy : dy;
+
+    if (rows > scroll_vsa) {
+        rows = scroll_vsa;
+    }
+
+    scroll_start = (scroll_start + shift % scroll_vsa + scroll_vsa) % scroll_vsa;
+    send_scroll_address();
+
+    if (exposed) {
+        exposed->x1 = 0;
+        exposed->x2 = LV_HOR_RES_MAX - 1;
+        exposed->y1 = dy < 0 ? scroll_top : scroll_bottom - rows + 1;
+        exposed->y2 = dy < 0 ? scroll_top + rows - 1 : scroll_bottom;
+    }
+}
+
+void disp_mipi_scroll_stop(void)
+{
+    disp_mipi_send_cmd(DISP_MIPI_NORON);
+    scroll_on = false;
+}
+
+void disp_mipi_invalidate_window(void)
+{
+    window_valid = false;
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+static void send_init_batch(disp_spi_segment_t *segs, size_t *count, bool wait)
+{
+    disp_spi_transaction_batch(segs, *count,
+        wait ? DISP_SPI_SEND_SYNCHRONOUS : DISP_SPI_SEND_QUEUED);
+    *count = 0;
+}
+
+static void write_pixels(const lv_color_t *color_map, size_t pixels, bool signal_flush)
+{
+    if (panel->write_pixels) {
+        panel->write_pixels(color_map, pixels, signal_flush);
+        return;
+    }
+
+    disp_spi_transaction_stream((const uint8_t *) color_map, pixels * panel->bytes_per_pixel,
+        DISP_SPI_SEND_QUEUED | DISP_SPI_DC_DATA | (signal_flush ? DISP_SPI_SIGNAL_FLUSH : 0), 0);
+}
+
+/* The rows of a flush are moved to where the scroll start address shows
+   them, the ones wrapping around the scroll area go in a second window */
+static void flush_scrolled(const lv_area_t *area, lv_color_t *color_map)
+{
+    lv_coord_t w = lv_area_get_width(area);
+    lv_coord_t y = area->y1;
+
+    while (y <= area->y2) {
+        uint16_t row = scroll_map_row(y + panel->y_offset);
+        lv_coord_t rows = 1;
+
+        while (y + rows <= area->y2 && scroll_map_row(y + rows + panel->y_offset) == row + rows) {
+            rows++;
+        }
+
+        disp_mipi_set_window(area->x1 + panel->x_offset, row,
+            area->x2 + panel->x_offset, row + rows - 1);
+        write_pixels(color_map, (size_t) w * rows, y + rows > area->y2);
+
+        color_map += (size_t) w * rows;
+        y += rows;
+    }
+}
+
+static uint16_t scroll_map_row(uint16_t row)
+{
+    bool flip = madctl & DISP_MIPI_MADCTL_MY;
+    uint16_t line = flip ? panel->memory_lines - 1 - row : row;
+
+    if (line >= scroll_tfa && line < scroll_tfa + scroll_vsa) {
+        line = scroll_tfa + (line - scroll_tfa + scroll_start) % scroll_vsa;
+    }
+
+    return flip ? panel->memory_lines - 1 - line : line;
+}
+
+static void send_scroll_address(void)
+{
+    uint16_t line = scroll_tfa + scroll_start;
+    uint8_t data[] = {(line >> 8) & 0xFF, line & 0xFF};
+
+    disp_mipi_send_cmd(DISP_MIPI_VSCRSADD);
+    disp_mipi_send_params(data, sizeof(data));
+}
+
+static void send_range(uint8_t cmd, uint16_t start, uint16_t end)
+{
+    uint8_t data[4] = {
+        (start >> 8) & 0xFF, start & 0xFF,
+        (end >> 8) & 0xFF, end & 0xFF,
+    };
+
+    disp_mipi_send_cmd(cmd);
+    disp_mipi_send_params(data, sizeof(data));
+}
@@ -0,0 +1,139 @@
+/**
+ * @file disp_mipi.h
+ *
+ * Common core of the MIPI DCS panels (ILI9341, ST7789, ST7796S, GC9A01,
+ * HX8357, ILI9486, ILI9488). The drivers describe their chip with a disp_mipi_panel_t
+ * and keep the GPIO, reset and backlight handling.
+ */
+
+#ifndef DISP_MIPI_H
+#define DISP_MIPI_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef LV_LVGL_H_INCLUDE_SIMPLE
+#include "lvgl.h"
+#else
+#include "lvgl/lvgl.h"
+#endif
+
+/*********************
+ *      DEFINES
+ *********************/
+#define DISP_MIPI_SWRESET   0x01
+#define DISP_MIPI_SLPIN     0x10
+#define DISP_MIPI_SLPOUT    0x11
+#define DISP_MIPI_NORON     0x13
+#define DISP_MIPI_INVOFF    0x20
+#define DISP_MIPI_INVON     0x21
+#define DISP_MIPI_CASET     0x2A
+#define DISP_MIPI_RASET     0x2B
+#define DISP_MIPI_RAMWR     0x2C
+#define DISP_MIPI_VSCRDEF   0x33
+#define DISP_MIPI_MADCTL    0x36
+#define DISP_MIPI_VSCRSADD  0x37
+
+/* MADCTL row/column bits */
+#define DISP_MIPI_MADCTL_MY 0x80
+#define DISP_MIPI_MADCTL_MX 0x40
+#define DISP_MIPI_MADCTL_MV 0x20
+
+/* databytes of the last disp_mipi_init_cmd_t entry */
+#define DISP_MIPI_INIT_END  0xFF
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+
+/* The panels need a bunch of command/argument values to be initialized */
+typedef struct {
+    uint8_t cmd;
+    uint8_t data[16];
+    uint8_t databytes; //No of data in data; DISP_MIPI_INIT_END = end of cmds.
+    uint8_t delay_ms;  //Wait after the command, from the datasheet
+} disp_mipi_init_cmd_t;
+
+typedef enum {
+    DISP_MIPI_INVERSION_BY_TABLE,   /* left to the init table */
+    DISP_MIPI_INVERSION_OFF,
+    DISP_MIPI_INVERSION_ON,
+} disp_mipi_inversion_t;
+
+typedef struct {
+    const char *name;                       /* used in the logs */
+    const disp_mipi_init_cmd_t *init_cmds;  /* NULL if the driver sends its own */
+    uint8_t madctl[4];                      /* per CONFIG_LV_DISPLAY_ORIENTATION */
+    uint16_t x_offset;                      /* added to the flushed areas */
+    uint16_t y_offset;
+    uint8_t bytes_per_pixel;
+    bool wide_bus;                          /* 16-bit commands and parameters */
+    disp_mipi_inversion_t inversion;
+    uint16_t memory_lines;                  /* frame memory rows, 0 if it can't scroll */
+    /* converts and sends the pixels after RAMWR, NULL to send lv_color_t as is */
+    void (*write_pixels)(const lv_color_t *color_map, size_t pixels, bool signal_flush);
+} disp_mipi_panel_t;
+
+/**********************
+ * GLOBAL PROTOTYPES
+ **********************/
+
+/* Send the init table, MADCTL and inversion of the panel, once it's out
+   of reset. The panel is used by all the functions below. */
+void disp_mipi_init(const disp_mipi_panel_t *panel);
+
+void disp_mipi_flush(lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t *color_map);
+
+void disp_mipi_set_orientation(uint8_t orientation);
+
+/* Pulse the RST GPIO (already an output) and wait until the panel accepts
+   commands */
+void disp_mipi_reset(int rst_gpio);
+void disp_mipi_soft_reset(void);
+
+/* Queue an init table in batches, only waiting for the bus where an entry
+   has a delay. SLPOUT is held back until 120 ms after the last reset. */
+void disp_mipi_send_init_cmds(const disp_mipi_init_cmd_t *cmds);
+
+/* vTaskDelay rounded up to the next tick */
+void disp_mipi_delay_ms(uint32_t ms);
+
+/* Queued, with the DC line set accordingly */
+void disp_mipi_send_cmd(uint8_t cmd);
+void disp_mipi_send_params(const uint8_t *data, size_t length);
+
+/* Set the column and page window and start a memory write. A column or page
+   range equal to the last one sent is skipped, RAMWR restarts at the window
+   origin anyway. */
+void disp_mipi_set_window(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2);
+
+/* Hardware vertical scrolling of the rows between top_fixed and
+   bottom_fixed (VSCRDEF). Not available when the orientation exchanges rows
+   and columns, false is returned then. */
+bool disp_mipi_scroll_init(uint16_t top_fixed, uint16_t bottom_fixed);
+
+/* Move the content of the scroll area up by dy rows (down if negative) with
+   VSCRSADD, the flushes are remapped to follow. exposed is set to the rows
+   left with stale content, to be invalidated; it can be NULL. */
+void disp_mipi_scroll(lv_coord_t dy, lv_area_t *exposed);
+
+/* Back to no scrolling, the whole screen has to be redrawn */
+void disp_mipi_scroll_stop(void);
+
+/* Forget the last window, after a reset or anything else sending CASET or
+   RASET */
+void disp_mipi_invalidate_window(void);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /*DISP_MIPI_H*/
@@ -0,0 +1,259 @@
+/**
+ * @file disp_pixconv.c
+ *
+ */
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include "disp_pixconv.h"
+
+#include <string.h>
+
+/*********************
+ *      DEFINES
+ *********************/
+
+/**********************
+ *      MACROS
+ **********************/
+#define SWAP16(p)       ((uint16_t) (((p) << 8) | ((p) >> 8)))
+
+/* RGB666: the 5 bit channels get the top bit copied below, as the
+   controllers only use the top 6 bits */
+#define R666(p)         ((((p) & 0xF800) >> 8) | (((p) & 0x8000) >> 13))
+#define G666(p)         (((p) & 0x07E0) >> 3)
+#define B666(p)         ((((p) & 0x001F) << 3) | (((p) & 0x0010) >> 2))
+
+/* RGB888: the top bits are replicated to fill the low bits */
+#define R888(p)         ((((p) >> 8) & 0xF8) | ((p) >> 13))
+#define G888(p)         ((((p) >> 3) & 0xFC) | (((p) >> 9) & 0x03))
+#define B888(p)         ((((p) << 3) & 0xF8) | (((p) >> 2) & 0x07))
+
+#define R444(p)         ((p) >> 12)
+#define G444(p)         (((p) >> 7) & 0x0F)
+#define B444(p)         (((p) >> 1) & 0x0F)
+
+/* 0x01 in each byte of a word that is zero, 0x00 otherwise */
+#define ZERO_BYTES(v)   (~((((v) & 0x7F7F7F7FU) + 0x7F7F7F7FU) | (v)) >> 7 & 0x01010101U)
+
+/* Four 0x00/0x01 bytes to four bits, the first byte in bit 0 */
+#define GATHER4(v)      ((((v) * 0x01020408U) >> 24) & 0x0F)
+
+/* One pixel into three bytes, kept a plain indexed loop so the compiler is
+   free to unroll or vectorize it */
+#define PACK_3BPP(dst, src, pixels, R, G, B)                                        \
+    do {                                                                            \
+        for (size_t i = 0; i < (pixels); i++) {                                     \
+            uint32_t p = (src)[i];                                                  \
+            (dst)[3 * i] = R(p);                                                    \
+            (dst)[3 * i + 1] = G(p);                                                \
+            (dst)[3 * i + 2] = B(p);                                                \
+        }                                                                           \
+    } while (0)
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+static inline uint32_t mono_bits8(const uint8_t *src);
+static inline void transpose8(uint32_t *lo, uint32_t *hi);
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+void disp_pixconv_swap16(uint16_t *dst, const uint16_t *src, size_t pixels)
+{
+    size_t i = 0;
+
+    /* two pixels per word when both sides are word aligned, which LVGL's
+       draw buffers always are */
+    if ((((uintptr_t) src | (uintptr_t) dst) & 3) == 0) {
+        const uint32_t *s = (const uint32_t *) src;
+        uint32_t *d = (uint32_t *) dst;
+        size_t words = pixels / 2;
+
+        for (size_t w = 0; w < words; w++) {
+            uint32_t v = s[w];
+            d[w] = ((v & 0x00FF00FF) << 8) | ((v >> 8) & 0x00FF00FF);
+        }
+
+        i = words * 2;
+    }
+
+    for (; i < pixels; i++) {
+        dst[i] = SWAP16(src[i]);
+    }
+}
+
+void disp_pixconv_rgb565_to_rgb666(uint8_t *dst, const uint16_t *src, size_t pixels)
+{
+    PACK_3BPP(dst, src, pixels, R666, G666, B666);
+}
+
+void disp_pixconv_rgb565_to_rgb888(uint8_t *dst, const uint16_t *src, size_t pixels)
+{
+    PACK_3BPP(dst, src, pixels, R888, G888, B888);
+}
+
+void disp_pixconv_rgb565_to_rgb444(uint8_t *dst, const uint16_t *src, size_t pixels)
+{
+    for (; pixels >= 2; pixels -= 2, src += 2) {
+        uint16_t p0 = src[0], p1 = src[1];
+        *dst++ = (R444(p0) << 4) | G444(p0);
+        *dst++ = (B444(p0) << 4) | R444(p1);
+        *dst++ = (G444(p1) << 4) | B444(p1);
+    }
+
+    if (pixels) {
+        *dst++ = (R444(*src) << 4) | G444(*src);
+        *dst++ = B444(*src) << 4;
+    }
+}
+
+void disp_pixconv_u8_to_be16(uint8_t *dst, const uint8_t *src, size_t length)
+{
+    for (; length > 0; length--) {
+        *dst++ = 0x00;
+        *dst++ = *src++;
+    }
+}
+
+void disp_pixconv_mono_page(uint8_t *dst, const uint8_t *src, uint16_t w, uint16_t h)
+{
+    for (uint16_t y = 0; y < h; y += 8, src += 8 * w) {
+        uint16_t rows = (h - y) < 8 ? (h - y) : 8;
+
+        if (rows == 8) {
+            for (uint16_t x = 0; x < w; x++) {
+                const uint8_t *s = &src[x];
+                *dst++ = (s[0] != 0)          | ((s[w] != 0) << 1) |
+                         ((s[2 * w] != 0) << 2) | ((s[3 * w] != 0) << 3) |
+                         ((s[4 * w] != 0) << 4) | ((s[5 * w] != 0) << 5) |
+                         ((s[6 * w] != 0) << 6) | ((s[7 * w] != 0) << 7);
+            }
+        } else {
+            /* last, partial page */
+            for (uint16_t x = 0; x < w; x++) {
+                uint8_t byte = 0;
+                for (uint16_t r = 0; r < rows; r++) {
+                    byte |= (src[x + r * w] != 0) << r;
+                }
+                *dst++ = byte;
+            }
+        }
+    }
+}
+
+void disp_pixconv_mono_row(uint8_t *dst, const uint8_t *src, uint16_t w, uint16_t h)
+{
+    for (uint16_t y = 0; y < h; y++) {
+        uint16_t x = 0;
+
+        for (; x + 8 <= w; x += 8, src += 8) {
+            *dst++ = ((src[0] != 0) << 7) | ((src[1] != 0) << 6) |
+                     ((src[2] != 0) << 5) | ((src[3] != 0) << 4) |
+                     ((src[4] != 0) << 3) | ((src[5] != 0) << 2) |
+                     ((src[6] != 0) << 1) |  (src[7] != 0);
+        }
+
+        if (x < w) {
+            uint8_t byte = 0;
+            for (uint8_t bit = 0x80; x < w; x++, bit >>= 1) {
+                if (*src++) {
+                    byte |= bit;
+                }
+            }
+            *dst++ = byte;
+        }
+    }
+}
+
+void disp_pixconv_mono_page_inv(uint8_t *dst, const uint8_t *src, uint16_t w, uint16_t h)
+{
+    for (uint16_t y = 0; y < h; y += 8, src += 8 * w) {
+        uint16_t rows = (h - y) < 8 ? (h - y) : 8;
+        uint16_t x = 0;
+
+        if (rows == 8) {
+            for (; x + 8 <= w; x += 8, dst += 8) {
+                uint32_t lo = 0, hi = 0;
+
+                /* one byte per row with the pixels in bits 0..7, rows 0..3
+                   in lo and 4..7 in hi, then transposed in place */
+                for (int r = 0; r < 4; r++) {
+                    lo |= mono_bits8(&src[x + r * w]) << (8 * r);
+                    hi |= mono_bits8(&src[x + (r + 4) * w]) << (8 * r);
+                }
+                transpose8(&lo, &hi);
+
+                memcpy(dst, &lo, 4);
+                memcpy(dst + 4, &hi, 4);
+            }
+        }
+
+        /* remaining columns and last, partial page */
+        for (; x < w; x++) {
+            uint8_t byte = 0;
+            for (uint16_t r = 0; r < rows; r++) {
+                byte |= (src[x + r * w] == 0) << r;
+            }
+            *dst++ = byte;
+        }
+    }
+}
+
+void disp_pixconv_mono_cols_inv(uint8_t *dst, const uint8_t *src, uint16_t w, uint16_t h)
+{
+    for (uint16_t x = 0; x < w; x += 8, dst += h) {
+        uint16_t cols = (w - x) < 8 ? (w - x) : 8;
+
+        for (uint16_t y = 0; y < h; y++) {
+            const uint8_t *s = &src[x + y * w];
+
+            if (cols == 8) {
+                dst[y] = mono_bits8(s);
+            } else {
+                uint8_t byte = 0;
+                for (uint16_t c = 0; c < cols; c++) {
+                    byte |= (s[c] == 0) << c;
+                }
+                dst[y] = byte;
+            }
+        }
+    }
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+/* Eight pixels to a byte, the zero ones set and the first one in bit 0 */
+static inline uint32_t mono_bits8(const uint8_t *src)
+{
+    uint32_t a, b;
+
+    /* the rows of a flush area aren't necessarily word aligned */
+    memcpy(&a, src, 4);
+    memcpy(&b, src + 4, 4);
+
+    return GATHER4(ZERO_BYTES(a)) | (GATHER4(ZERO_BYTES(b)) << 4);
+}
+
+/* 8x8 bit matrix transpose, Hacker's Delight transpose8rS32: row r in byte
+   r (rows 0..3 in lo), column c in bit c. */
+static inline void transpose8(uint32_t *lo, uint32_t *hi)
+{
+    uint32_t x = *hi, y = *lo, t;
+
+    t = (x ^ (x >> 7)) & 0x00AA00AAU;  x = x ^ t ^ (t << 7);
+    t = (y ^ (y >> 7)) & 0x00AA00AAU;  y = y ^ t ^ (t << 7);
+    t = (x ^ (x >> 14)) & 0x0000CCCCU; x = x ^ t ^ (t << 14);
+    t = (y ^ (y >> 14)) & 0x0000CCCCU; y = y ^ t ^ (t << 14);
+
+    t = (x & 0xF0F0F0F0U) | ((y >> 4) & 0x0F0F0F0FU);
+    y = ((x << 4) & 0xF0F0F0F0U) | (y & 0x0F0F0F0FU);
+
+    *hi = t;
+    *lo = y;
+}
@@ -0,0 +1,114 @@
+/**
+ * @file disp_pixconv.h
+ *
+ * Pixel format conversion shared by the display controllers.
+ */
+
+#ifndef DISP_PIXCONV_H
+#define DISP_PIXCONV_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "sdkconfig.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+/* LVGL colors to the pixel format of the selected controller, chosen at
+   compile time from Kconfig. DISP_PIXCONV_BYTES gives the converted size
+   of a number of pixels. Only RGB565 swapped can convert in place. */
+#if defined (CONFIG_LV_TFT_DISPLAY_PIXEL_FORMAT_RGB666)
+#define DISP_PIXCONV_BYTES(pixels)      ((pixels) * 3)
+#define disp_pixconv_from_lv(dst, color_map, pixels) \
+    disp_pixconv_rgb565_to_rgb666((uint8_t *) (dst), (const uint16_t *) (color_map), (pixels))
+#elif defined (CONFIG_LV_TFT_DISPLAY_PIXEL_FORMAT_RGB888)
+#define DISP_PIXCONV_BYTES(pixels)      ((pixels) * 3)
+#define disp_pixconv_from_lv(dst, color_map, pixels) \
+    disp_pixconv_rgb565_to_rgb888((uint8_t *) (dst), (const uint16_t *) (color_map), (pixels))
+#elif defined (CONFIG_LV_TFT_DISPLAY_PIXEL_FORMAT_RGB444)
+#define DISP_PIXCONV_BYTES(pixels)      (((pixels) * 3 + 1) / 2)
+#define disp_pixconv_from_lv(dst, color_map, pixels) \
+    disp_pixconv_rgb565_to_rgb444((uint8_t *) (dst), (const uint16_t *) (color_map), (pixels))
+#elif defined (CONFIG_LV_TFT_DISPLAY_PIXEL_FORMAT_RGB565_SWAPPED)
+#define DISP_PIXCONV_BYTES(pixels)      ((pixels) * 2)
+#define disp_pixconv_from_lv(dst, color_map, pixels) \
+    disp_pixconv_swap16((uint16_t *) (dst), (const uint16_t *) (color_map), (pixels))
+#endif
+
+/**********************
+ * GLOBAL PROTOTYPES
+ **********************/
+
+/* Swap the bytes of RGB565 pixels, dst may be src */
+void disp_pixconv_swap16(uint16_t *dst, const uint16_t *src, size_t pixels);
+
+/* RGB565 to 3 bytes per pixel, dst must be word aligned. RGB666 only keeps
+   the top 6 bits of each byte. */
+void disp_pixconv_rgb565_to_rgb666(uint8_t *dst, const uint16_t *src, size_t pixels);
+void disp_pixconv_rgb565_to_rgb888(uint8_t *dst, const uint16_t *src, size_t pixels);
+
+/* RGB565 to RGB444, two pixels in 3 bytes */
+void disp_pixconv_rgb565_to_rgb444(uint8_t *dst, const uint16_t *src, size_t pixels);
+
+/* 8-bit values to big endian 16-bit words, for controllers with 16-bit
+   parameters */
+void disp_pixconv_u8_to_be16(uint8_t *dst, const uint8_t *src, size_t length);
+
+/* One byte per pixel, non zero set, to 1bpp. Page packed bytes hold 8
+   vertical pixels with the top one in bit 0, (h + 7) / 8 pages of w bytes.
+   Row packed bytes hold 8 horizontal pixels with the left one in bit 7,
+   h rows of (w + 7) / 8 bytes. */
+void disp_pixconv_mono_page(uint8_t *dst, const uint8_t *src, uint16_t w, uint16_t h);
+void disp_pixconv_mono_row(uint8_t *dst, const uint8_t *src, uint16_t w, uint16_t h);
+
+/* Page packing of a LVGL buffer rendered with LV_COLOR_DEPTH 1, instead of
+   a set_px callback per pixel. The monochrome themes draw the lit pixels in
+   black, so here the zero pixels are set. The cols variant packs the pages
+   along x for panels mounted sideways, (w + 7) / 8 pages of h bytes with the
+   left pixel in bit 0. Both work on 8x8 blocks a word at a time. */
+void disp_pixconv_mono_page_inv(uint8_t *dst, const uint8_t *src, uint16_t w, uint16_t h);
+void disp_pixconv_mono_cols_inv(uint8_t *dst, const uint8_t *src, uint16_t w, uint16_t h);
+
+/* Single pixel variants, for the set_px callbacks. The msb variant fills
+   the pages from bit 7 down, as the IL3820 expects. */
+static inline void disp_pixconv_mono_page_set(uint8_t *buf, uint16_t stride,
+    uint16_t x, uint16_t y, bool on)
+{
+    uint8_t *byte = &buf[x + (y >> 3) * stride];
+    uint8_t mask = 1U << (y & 0x7);
+
+    *byte = on ? (*byte | mask) : (*byte & ~mask);
+}
+
+static inline void disp_pixconv_mono_page_set_msb(uint8_t *buf, uint16_t stride,
+    uint16_t x, uint16_t y, bool on)
+{
+    uint8_t *byte = &buf[x + (y >> 3) * stride];
+    uint8_t mask = 0x80U >> (y & 0x7);
+
+    *byte = on ? (*byte | mask) : (*byte & ~mask);
+}
+
+static inline void disp_pixconv_mono_row_set(uint8_t *buf, uint16_t row_len,
+    uint16_t x, uint16_t y, bool on)
+{
+    uint8_t *byte = &buf[(x >> 3) + y * row_len];
+    uint8_t mask = 0x80U >> (x & 0x7);
+
+    *byte = on ? (*byte | mask) : (*byte & ~mask);
+}
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /*DISP_PIXCONV_H*/
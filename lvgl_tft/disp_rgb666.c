@@ -0,0 +1,78 @@
+/**
+ * @file disp_rgb666.c
+ *
+ */
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include "disp_rgb666.h"
+#include "disp_spi.h"
+#include "disp_pixconv.h"
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+
+#include <assert.h>
+
+/*********************
+ *      DEFINES
+ *********************/
+#define TAG "disp_rgb666"
+
+#define STRIPE_BYTES    DISP_PIXCONV_BYTES(DISP_RGB666_STRIPE_PIXELS)
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+static uint8_t *stripe_buf[2];
+static uint32_t stripe_fence[2];
+static uint8_t stripe_next;
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+void disp_rgb666_init(void)
+{
+    if (stripe_buf[0] != NULL) {
+        return;
+    }
+
+    for (int i = 0; i < 2; i++) {
+        stripe_buf[i] = (uint8_t *) heap_caps_malloc(STRIPE_BYTES, MALLOC_CAP_DMA);
+        assert(stripe_buf[i] != NULL);
+        stripe_fence[i] = disp_spi_fence();
+    }
+
+    ESP_LOGI(TAG, "2 x %d bytes stripe buffers", STRIPE_BYTES);
+}
+
+void disp_rgb666_send_pixels(const lv_color_t *color_map, size_t pixels)
+{
+    disp_rgb666_write_pixels(color_map, pixels, true);
+}
+
+void disp_rgb666_write_pixels(const lv_color_t *color_map, size_t pixels, bool signal_flush)
+{
+    const uint16_t *src = (const uint16_t *) color_map;
+
+    while (pixels > 0) {
+        size_t n = pixels < DISP_RGB666_STRIPE_PIXELS ? pixels : DISP_RGB666_STRIPE_PIXELS;
+        uint8_t *buf = stripe_buf[stripe_next];
+
+        /* the previous stripe out of this buffer has to be on the wire first */
+        disp_spi_wait_fence(stripe_fence[stripe_next]);
+        disp_pixconv_from_lv(buf, src, n);
+
+        src += n;
+        pixels -= n;
+        if (pixels > 0 || !signal_flush) {
+            disp_spi_transaction_stream(buf, DISP_PIXCONV_BYTES(n), DISP_SPI_SEND_QUEUED | DISP_SPI_DC_DATA, 0);
+        } else {
+            disp_spi_send_pixels(buf, DISP_PIXCONV_BYTES(n));
+        }
+
+        stripe_fence[stripe_next] = disp_spi_fence();
+        stripe_next ^= 1;
+    }
+}
@@ -0,0 +1,53 @@
+/**
+ * @file disp_rgb666.h
+ *
+ * RGB565 to RGB666 conversion for the controllers only taking 18-bit
+ * pixels over SPI (ILI9481, ILI9488).
+ */
+
+#ifndef DISP_RGB666_H
+#define DISP_RGB666_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef LV_LVGL_H_INCLUDE_SIMPLE
+#include "lvgl.h"
+#else
+#include "lvgl/lvgl.h"
+#endif
+
+/*********************
+ *      DEFINES
+ *********************/
+/* Pixels converted per stripe, a multiple of 4 */
+#define DISP_RGB666_STRIPE_PIXELS   (LV_HOR_RES_MAX * 4)
+
+/**********************
+ * GLOBAL PROTOTYPES
+ **********************/
+
+/* Allocate the two DMA stripe buffers, called once from the controller init */
+void disp_rgb666_init(void);
+
+/* Convert and queue the pixels of a flush after the memory write command,
+   one stripe is converted while the other one is on the wire. The last
+   stripe signals the flush as done. */
+void disp_rgb666_send_pixels(const lv_color_t *color_map, size_t pixels);
+
+/* Same, for a flush sent in several parts: only signal the flush as done
+   from the last one */
+void disp_rgb666_write_pixels(const lv_color_t *color_map, size_t pixels, bool signal_flush);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /*DISP_RGB666_H*/
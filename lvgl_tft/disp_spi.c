@@ -13,9 +13,14 @@
 
 #define TAG "disp_spi"
 
+#include <stdlib.h>
 #include <string.h>
+#include <stdatomic.h>
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
 
 #include <freertos/FreeRTOS.h>
+#include <freertos/event_groups.h>
 #include <freertos/semphr.h>
 #include <freertos/task.h>
 
@@ -34,17 +39,20 @@
 /******************************************************************************
  * Notes about DMA spi_transaction_ext_t structure pooling
  * 
- * An xQueue is used to hold a pool of reusable SPI spi_transaction_ext_t 
- * structures that get used for all DMA SPI transactions. While an xQueue may 
- * seem like overkill it is an already built-in RTOS feature that comes at 
- * little cost. xQueues are also ISR safe if it ever becomes necessary to 
- * access the pool in the ISR callback.
+ * A fixed-size lock-free ring holds a pool of reusable SPI spi_transaction_ext_t 
+ * structures that get used for all DMA SPI transactions. Free slots are pushed 
+ * and popped through an atomic head and tail, every ring cell carries a 
+ * sequence number telling whether it is ready to be pushed into or popped 
+ * from. No critical section is taken on the hot path, and pushing or popping 
+ * is also safe from the ISR callback (i.e. spi_ready).
  * 
  * When a DMA request is sent, a transaction structure is removed from the 
  * pool, filled out, and passed off to the esp32 SPI driver. Later, when 
  * servicing pending SPI transaction results, the transaction structure is 
  * recycled back into the pool for later reuse. This matches the DMA SPI 
- * transaction life cycle requirements of the esp32 SPI driver.
+ * transaction life cycle requirements of the esp32 SPI driver, which only 
+ * releases its private DMA buffers of a transaction once its result has 
+ * been retrieved.
  * 
  * When polling or synchronously sending SPI requests, and as required by the 
  * esp32 SPI driver, all pending DMA transactions are first serviced. Then the 
@@ -55,6 +63,11 @@
  * any new DMA SPI transactions. Not too many and not too few as this balance 
  * controls DMA transaction latency.
  * 
+ * Waiting for transactions doesn't poll. Completed transactions are counted 
+ * in spi_ready, which gives a semaphore once the number in flight drops to 
+ * what the waiting task asked for, the waiter then collects the results 
+ * without blocking. 
+ * 
  * It is therefore not the design that all pending transactions must be 
  * serviced and placed back into the pool with DMA SPI requests - that 
  * will happen eventually. The pool just needs to contain enough to float some 
@@ -63,37 +76,189 @@
  * polling SPI requests or calls disp_wait_for_pending_transactions() directly,
  * the pool will reach the full state more often and speed up DMA queuing.
  * 
+ * Each pool entry also carries a small DMA capable buffer. Queued transactions
+ * of up to DISP_SPI_INLINE_DATA_SIZE bytes are copied into it, so command
+ * parameters can be queued straight from the stack of the caller.
+ * 
+ * Notes about the DC line
+ * 
+ * Transactions flagged with DISP_SPI_DC_CMD or DISP_SPI_DC_DATA get the DC 
+ * line set in the pre transfer callback, right before the transaction goes 
+ * out on the bus. Drivers don't need to wait for pending transactions to 
+ * toggle the DC line by hand, so a complete flush (window setup, memory 
+ * write command and pixel data) can be queued back-to-back.
+ * 
+ * Notes about the SPI clock
+ * 
+ * Two SPI devices are registered for the display, one at the display clock 
+ * and one at the slow clock (SPI_TFT_SLOW_CLOCK_SPEED_HZ). As two devices 
+ * can't share a hardware CS pin, CS is driven from the pre and post transfer 
+ * callbacks. Transactions flagged with DISP_SPI_CLOCK_SLOW, or all of them 
+ * after disp_spi_use_slow_clock(true), go to the slow device. The queue of 
+ * one device is drained before queueing to the other one, so transactions 
+ * still go out in order.
+ * 
+ * Notes about instances
+ * 
+ * Every disp_spi_dev_t has its own SPI devices, CS and DC pins and pool, so 
+ * panels on separate hosts can be fed concurrently. The disp_spi_* functions 
+ * without a handle work on a default instance set up by disp_spi_add_device. 
+ * Transactions carry the lv_disp_drv_t to signal in their user field, set 
+ * with disp_spi_dev_set_disp_drv(). The display being refreshed is only used 
+ * when no driver was set.
+ * 
+ * Notes about sharing the bus with the touch controller
+ * 
+ * The SPI driver serves the display device for as long as its queue is not 
+ * empty, so a touch sample could wait for a whole frame. When the bus is 
+ * shared, pixel streams keep only a couple of chunks in flight and stop 
+ * queueing new chunks while a high priority request (touch sample, register 
+ * read) is pending, see disp_spi_priority_request().
+ * 
  *****************************************************************************/
 
 /*********************
  *      DEFINES
  *********************/
+#if defined (CONFIG_LV_DISP_SPI_TRANSACTION_POOL_SIZE)
+#define SPI_TRANSACTION_POOL_SIZE CONFIG_LV_DISP_SPI_TRANSACTION_POOL_SIZE
+#else
 #define SPI_TRANSACTION_POOL_SIZE 50	/* maximum number of DMA transactions simultaneously in-flight */
+#endif
 
 /* DMA Transactions to reserve before queueing additional DMA transactions. A 1/10th seems to be a good balance. Too many (or all) and it will increase latency. */
+#if defined (CONFIG_LV_DISP_SPI_TRANSACTION_POOL_RESERVE_PERCENTAGE)
+#define SPI_TRANSACTION_POOL_RESERVE_PERCENTAGE CONFIG_LV_DISP_SPI_TRANSACTION_POOL_RESERVE_PERCENTAGE
+#else
 #define SPI_TRANSACTION_POOL_RESERVE_PERCENTAGE 10
-#if SPI_TRANSACTION_POOL_SIZE >= SPI_TRANSACTION_POOL_RESERVE_PERCENTAGE
-#define SPI_TRANSACTION_POOL_RESERVE (SPI_TRANSACTION_POOL_SIZE / SPI_TRANSACTION_POOL_RESERVE_PERCENTAGE)	
+#endif
+#if (SPI_TRANSACTION_POOL_SIZE * SPI_TRANSACTION_POOL_RESERVE_PERCENTAGE) >= 100
+#define SPI_TRANSACTION_POOL_RESERVE ((SPI_TRANSACTION_POOL_SIZE * SPI_TRANSACTION_POOL_RESERVE_PERCENTAGE) / 100)
 #else
 #define SPI_TRANSACTION_POOL_RESERVE 1	/* defines minimum size */
 #endif
 
+/* Adaptive reserve: waiting less than MIN for free transactions means the
+ * wake-ups cost more than the wait, so the reserve grows. Waiting more than
+ * MAX holds the flushing task too long, so the reserve shrinks. In between
+ * the reserve heads for the number of transactions the bus completes in
+ * TARGET, from the measured completion latency. */
+#define SPI_ADAPTIVE_RESERVE_MIN_WAIT_US    100
+#define SPI_ADAPTIVE_RESERVE_MAX_WAIT_US    2000
+#define SPI_ADAPTIVE_RESERVE_TARGET_WAIT_US 500
+#define SPI_ADAPTIVE_RESERVE_MAX            ((SPI_TRANSACTION_POOL_SIZE + 1) / 2)
+
+/* The ring must be a power of two at least as big as the pool */
+#if SPI_TRANSACTION_POOL_SIZE <= 16
+#define SPI_TRANSACTION_RING_SIZE 16
+#elif SPI_TRANSACTION_POOL_SIZE <= 32
+#define SPI_TRANSACTION_RING_SIZE 32
+#elif SPI_TRANSACTION_POOL_SIZE <= 64
+#define SPI_TRANSACTION_RING_SIZE 64
+#elif SPI_TRANSACTION_POOL_SIZE <= 128
+#define SPI_TRANSACTION_RING_SIZE 128
+#else
+#error "SPI_TRANSACTION_POOL_SIZE is too big"
+#endif
+#define SPI_TRANSACTION_RING_MASK (SPI_TRANSACTION_RING_SIZE - 1)
+
+/* Largest chunk sent by disp_spi_transaction_stream. It can't exceed the bus
+ * max transfer size, and is capped to 32KB as newer targets don't support
+ * longer transactions. Chunks are a multiple of 12 bytes so they always hold
+ * whole 16 and 24 bits pixels. */
+#define SPI_STREAM_CHUNK_LIMIT  (32 * 1024)
+#define SPI_STREAM_CHUNK_SIZE   ((SPI_BUS_MAX_TRANSFER_SZ < SPI_STREAM_CHUNK_LIMIT ? \
+                                  SPI_BUS_MAX_TRANSFER_SZ : SPI_STREAM_CHUNK_LIMIT) / 12 * 12)
+
+/* Stream chunks in flight on a shared bus, this bounds how long a high
+ * priority request waits behind pixel data */
+#define SPI_SHARED_BUS_STREAM_INFLIGHT 2
+
+/* Set in priority_idle while no high priority request is pending */
+#define PRIORITY_IDLE_BIT   (1 << 0)
+
 /**********************
  *      TYPEDEFS
  **********************/
+typedef struct {
+    spi_transaction_ext_t t;    /* must be the first member, the SPI driver hands it back to us */
+    disp_spi_dev_t *dev;
+    disp_spi_send_flag_t flags;
+    bool queued;                /* counted in flight, not a polling transaction */
+    uint16_t depth;             /* in flight once queued, this one included */
+    uint32_t queued_us;         /* esp_timer time when queued and completed */
+    uint32_t done_us;
+    WORD_ALIGNED_ATTR uint8_t data[DISP_SPI_INLINE_DATA_SIZE];
+} disp_spi_trans_t;
+
+typedef struct {
+    atomic_uint seq;            /* == position: free to push into, == position + 1: ready to pop */
+    disp_spi_trans_t *trans;
+} disp_spi_pool_cell_t;
+
+struct _disp_spi_dev_t {
+    spi_host_device_t host;
+    spi_device_handle_t spi;            /* display clock */
+    spi_device_handle_t spi_slow;       /* SPI_TFT_SLOW_CLOCK_SPEED_HZ */
+    spi_device_handle_t spi_queued;     /* device of the pending queued transactions */
+    spi_device_handle_t spi_acquired;
+    bool slow_clock;
+    int cs;
+    int dc;
+    transaction_cb_t chained_pre_cb;
+    transaction_cb_t chained_post_cb;
+    lv_disp_drv_t *disp_drv;            /* passed to lv_disp_flush_ready */
+    disp_spi_trans_t *pool_trans;       /* NULL until the pool is created */
+    disp_spi_pool_cell_t pool_cells[SPI_TRANSACTION_RING_SIZE];
+    atomic_uint pool_head;              /* next position to push into */
+    atomic_uint pool_tail;              /* next position to pop from */
+    atomic_uint inflight;               /* queued and not completed yet */
+    uint32_t queued_seq;                /* transactions queued so far, for fences */
+    volatile unsigned wait_threshold;   /* wake the waiter once inflight drops to this */
+    volatile bool waiting;
+    SemaphoreHandle_t done;
+    unsigned reserve;                   /* slots to free up once the pool ran empty */
+    disp_spi_stats_t stats;
+    uint64_t stats_bytes;
+    uint32_t latency_x8;                /* averages of the queue to completion time */
+    uint32_t service_x8;                /* and of the bus time per transaction, times 8 */
+};
 
 /**********************
  *  STATIC PROTOTYPES
  **********************/
+static void IRAM_ATTR spi_pre_transfer (spi_transaction_t *trans);
 static void IRAM_ATTR spi_ready (spi_transaction_t *trans);
+static void dev_add_devices(disp_spi_dev_t *dev, spi_host_device_t host,
+    spi_device_interface_config_t *devcfg, int dc);
+static void dev_remove_devices(disp_spi_dev_t *dev);
+static void trans_fill(disp_spi_dev_t *dev, disp_spi_trans_t *t, const uint8_t *data, size_t length,
+    disp_spi_send_flag_t flags, uint8_t *out, uint64_t addr, uint8_t dummy_bits);
+static void trans_queue(disp_spi_dev_t *dev, spi_device_handle_t handle, const disp_spi_trans_t *t,
+    const uint8_t *data, size_t length);
+static inline spi_device_handle_t trans_device(disp_spi_dev_t *dev, disp_spi_send_flag_t flags);
+static void stream_yield(disp_spi_dev_t *dev);
+static lv_disp_drv_t *dev_disp_drv(disp_spi_dev_t *dev);
+static void pool_create(disp_spi_dev_t *dev);
+static void pool_reserve(disp_spi_dev_t *dev, unsigned count);
+static void wait_inflight(disp_spi_dev_t *dev, unsigned threshold);
+static void adapt_reserve(disp_spi_dev_t *dev, int64_t wait_us);
+static void trans_done(disp_spi_dev_t *dev, disp_spi_trans_t *trans);
+static void pool_init(disp_spi_dev_t *dev);
+static bool IRAM_ATTR pool_push(disp_spi_dev_t *dev, disp_spi_trans_t *trans);
+static disp_spi_trans_t * IRAM_ATTR pool_pop(disp_spi_dev_t *dev);
+static inline unsigned pool_available(disp_spi_dev_t *dev);
 
 /**********************
  *  STATIC VARIABLES
  **********************/
-static spi_host_device_t spi_host;
-static spi_device_handle_t spi;
-static QueueHandle_t TransactionPool = NULL;
-static transaction_cb_t chained_post_cb;
+static disp_spi_dev_t default_dev = {
+    .cs = -1,
+    .dc = -1,
+};
+static unsigned priority_pending;       /* high priority requests waiting for the bus */
+static SemaphoreHandle_t priority_lock; /* guards priority_pending and the idle bit */
+static EventGroupHandle_t priority_idle;
 
 /**********************
  *      MACROS
@@ -104,11 +269,7 @@ static transaction_cb_t chained_post_cb;
  **********************/
 void disp_spi_add_device_config(spi_host_device_t host, spi_device_interface_config_t *devcfg)
 {
-    spi_host=host;
-    chained_post_cb=devcfg->post_cb;
-    devcfg->post_cb=spi_ready;
-    esp_err_t ret=spi_bus_add_device(host, devcfg, &spi);
-    assert(ret==ESP_OK);
+    dev_add_devices(&default_dev, host, devcfg, DISP_SPI_DC);
 }
 
 void disp_spi_add_device(spi_host_device_t host)
@@ -143,17 +304,9 @@ void disp_spi_add_device_with_speed(spi_host_device_t host, int clock_speed_hz)
 
     disp_spi_add_device_config(host, &devcfg);
 
-	/* create the transaction pool and fill it with ptrs to spi_transaction_ext_t to reuse */
-	if(TransactionPool == NULL) {
-		TransactionPool = xQueueCreate(SPI_TRANSACTION_POOL_SIZE, sizeof(spi_transaction_ext_t*));
-		assert(TransactionPool != NULL);
-		for (size_t i = 0; i < SPI_TRANSACTION_POOL_SIZE; i++)
-		{
-			spi_transaction_ext_t* pTransaction = (spi_transaction_ext_t*)heap_caps_malloc(sizeof(spi_transaction_ext_t), MALLOC_CAP_DMA);
-			assert(pTransaction != NULL);
-			memset(pTransaction, 0, sizeof(spi_transaction_ext_t));
-			xQueueSend(TransactionPool, &pTransaction, portMAX_DELAY);
-		}
+	/* the pool outlives the device, it's kept when changing the clock speed */
+	if (default_dev.pool_trans == NULL) {
+		pool_create(&default_dev);
 	}
 }
 
@@ -164,157 +317,724 @@ void disp_spi_change_device_speed(int clock_speed_hz)
     }
     ESP_LOGI(TAG, "Changing SPI device clock speed: %d", clock_speed_hz);
     disp_spi_remove_device();
-    disp_spi_add_device_with_speed(spi_host, clock_speed_hz);
+    disp_spi_add_device_with_speed(default_dev.host, clock_speed_hz);
 }
 
 void disp_spi_remove_device()
 {
-    /* Wait for previous pending transaction results */
-    disp_wait_for_pending_transactions();
+    dev_remove_devices(&default_dev);
+}
 
-    esp_err_t ret=spi_bus_remove_device(spi);
-    assert(ret==ESP_OK);
+void disp_spi_use_slow_clock(bool slow)
+{
+    disp_spi_dev_use_slow_clock(&default_dev, slow);
+}
+
+void disp_spi_set_disp_drv(struct _disp_drv_t *drv)
+{
+    disp_spi_dev_set_disp_drv(&default_dev, drv);
 }
 
 void disp_spi_transaction(const uint8_t *data, size_t length,
     disp_spi_send_flag_t flags, uint8_t *out,
     uint64_t addr, uint8_t dummy_bits)
+{
+    disp_spi_dev_transaction(&default_dev, data, length, flags, out, addr, dummy_bits);
+}
+
+void disp_spi_transaction_batch(const disp_spi_segment_t *segs, size_t count,
+    disp_spi_send_flag_t flags)
+{
+    disp_spi_dev_transaction_batch(&default_dev, segs, count, flags);
+}
+
+void disp_spi_transaction_stream(const uint8_t *data, size_t length,
+    disp_spi_send_flag_t flags, uint64_t addr)
+{
+    disp_spi_dev_transaction_stream(&default_dev, data, length, flags, addr);
+}
+
+void disp_wait_for_pending_transactions(void)
+{
+    disp_spi_dev_wait_for_pending_transactions(&default_dev);
+}
+
+void disp_spi_acquire(void)
+{
+    disp_spi_dev_acquire(&default_dev);
+}
+
+void disp_spi_release(void)
+{
+    disp_spi_dev_release(&default_dev);
+}
+
+void disp_spi_get_stats(disp_spi_stats_t *stats)
+{
+    disp_spi_dev_get_stats(&default_dev, stats);
+}
+
+void disp_spi_reset_stats(void)
+{
+    disp_spi_dev_reset_stats(&default_dev);
+}
+
+uint32_t disp_spi_fence(void)
+{
+    return disp_spi_dev_fence(&default_dev);
+}
+
+void disp_spi_wait_fence(uint32_t fence)
+{
+    disp_spi_dev_wait_fence(&default_dev, fence);
+}
+
+disp_spi_dev_t *disp_spi_dev_create(spi_host_device_t host, spi_device_interface_config_t *devcfg, int dc)
+{
+    disp_spi_dev_t *dev = (disp_spi_dev_t *) calloc(1, sizeof(disp_spi_dev_t));
+    assert(dev != NULL);
+
+    if (dc >= 0) {
+        gpio_pad_select_gpio(dc);
+        gpio_set_direction(dc, GPIO_MODE_OUTPUT);
+    }
+
+    dev_add_devices(dev, host, devcfg, dc);
+    pool_create(dev);
+
+    return dev;
+}
+
+void disp_spi_dev_delete(disp_spi_dev_t *dev)
+{
+    assert(dev != &default_dev);
+
+    dev_remove_devices(dev);
+    heap_caps_free(dev->pool_trans);
+    free(dev);
+}
+
+void disp_spi_dev_use_slow_clock(disp_spi_dev_t *dev, bool slow)
+{
+    dev->slow_clock = slow;
+}
+
+void disp_spi_dev_set_disp_drv(disp_spi_dev_t *dev, struct _disp_drv_t *drv)
+{
+    dev->disp_drv = drv;
+}
+
+void disp_spi_dev_transaction(disp_spi_dev_t *dev, const uint8_t *data, size_t length,
+    disp_spi_send_flag_t flags, uint8_t *out,
+    uint64_t addr, uint8_t dummy_bits)
 {
     if (0 == length) {
         return;
     }
 
-    spi_transaction_ext_t t = {0};
+    disp_spi_trans_t t;
+    spi_device_handle_t handle = trans_device(dev, flags);
+    trans_fill(dev, &t, data, length, flags, out, addr, dummy_bits);
+
+    /* Poll/Complete/Queue transaction */
+    if (flags & DISP_SPI_SEND_POLLING) {
+		disp_spi_dev_wait_for_pending_transactions(dev);	/* before polling, all previous pending transactions need to be serviced */
+        spi_device_polling_transmit(handle, (spi_transaction_t *) &t);
+    } else if (flags & DISP_SPI_SEND_SYNCHRONOUS) {
+		disp_spi_dev_wait_for_pending_transactions(dev);	/* before synchronous queueing, all previous pending transactions need to be serviced */
+        spi_device_transmit(handle, (spi_transaction_t *) &t);
+    } else {
+        trans_queue(dev, handle, &t, data, length);
+    }
+}
+
+void disp_spi_dev_transaction_batch(disp_spi_dev_t *dev, const disp_spi_segment_t *segs, size_t count,
+    disp_spi_send_flag_t flags)
+{
+    const disp_spi_send_flag_t seg_mask = (disp_spi_send_flag_t)
+        ~(DISP_SPI_SEND_POLLING | DISP_SPI_SEND_SYNCHRONOUS | DISP_SPI_SIGNAL_FLUSH | DISP_SPI_RECEIVE);
+    disp_spi_trans_t t;
+    size_t i = 0;
+
+    /* empty segments are skipped, the last one with data signals the flush */
+    while (count > 0 && 0 == segs[count - 1].length) {
+        count--;
+    }
+
+    if (count == 0) {
+        if (flags & DISP_SPI_SIGNAL_FLUSH) {
+            /* the transactions queued before may still read the buffer */
+            disp_spi_dev_wait_for_pending_transactions(dev);
+            lv_disp_flush_ready(dev_disp_drv(dev));
+        }
+        return;
+    }
+
+    while (i < count) {
+        /* take the pool slots for the whole group in one go instead of one by one */
+        size_t group = count - i;
+        if (group > SPI_TRANSACTION_POOL_SIZE) {
+            group = SPI_TRANSACTION_POOL_SIZE;
+        }
+        pool_reserve(dev, group);
+
+        for (; group > 0; group--, i++) {
+            disp_spi_send_flag_t seg_flags = (disp_spi_send_flag_t) (segs[i].flags & seg_mask);
+
+            if (0 == segs[i].length) {
+                continue;
+            }
+
+            /* a single completion signal for the whole batch */
+            if (i == count - 1) {
+                seg_flags |= (flags & DISP_SPI_SIGNAL_FLUSH);
+            }
+
+            trans_fill(dev, &t, segs[i].data, segs[i].length, seg_flags, NULL, segs[i].addr, 0);
+            trans_queue(dev, trans_device(dev, seg_flags), &t, segs[i].data, segs[i].length);
+        }
+    }
+
+    if (flags & (DISP_SPI_SEND_POLLING | DISP_SPI_SEND_SYNCHRONOUS)) {
+        disp_spi_dev_wait_for_pending_transactions(dev);
+    }
+}
+
+void disp_spi_dev_transaction_stream(disp_spi_dev_t *dev, const uint8_t *data, size_t length,
+    disp_spi_send_flag_t flags, uint64_t addr)
+{
+    const disp_spi_send_flag_t chunk_flags = (disp_spi_send_flag_t) (flags & ~DISP_SPI_SIGNAL_FLUSH);
+
+    assert(!(flags & DISP_SPI_RECEIVE));
+
+    while (length > SPI_STREAM_CHUNK_SIZE) {
+        stream_yield(dev);
+        disp_spi_dev_transaction(dev, data, SPI_STREAM_CHUNK_SIZE, chunk_flags, NULL, addr, 0);
+        data += SPI_STREAM_CHUNK_SIZE;
+        length -= SPI_STREAM_CHUNK_SIZE;
+    }
+
+    stream_yield(dev);
+    disp_spi_dev_transaction(dev, data, length, flags, NULL, addr, 0);
+}
+
+void disp_spi_dev_wait_for_pending_transactions(disp_spi_dev_t *dev)
+{
+	pool_reserve(dev, SPI_TRANSACTION_POOL_SIZE);	/* service until the transaction reuse pool is full again */
+}
+
+void disp_spi_dev_acquire(disp_spi_dev_t *dev)
+{
+    spi_device_handle_t handle = trans_device(dev, 0);
+    esp_err_t ret = spi_device_acquire_bus(handle, portMAX_DELAY);
+    assert(ret == ESP_OK);
+    dev->spi_acquired = handle;
+}
+
+void disp_spi_dev_release(disp_spi_dev_t *dev)
+{
+    spi_device_handle_t handle = dev->spi_acquired;
+    dev->spi_acquired = NULL;
+    spi_device_release_bus(handle);
+}
+
+void disp_spi_dev_get_stats(disp_spi_dev_t *dev, disp_spi_stats_t *stats)
+{
+    *stats = dev->stats;
+    stats->avg_transaction_size = dev->stats.transactions ?
+        (uint32_t) (dev->stats_bytes / dev->stats.transactions) : 0;
+    stats->reserve = dev->reserve;
+    stats->avg_latency_us = dev->latency_x8 / 8;
+}
+
+void disp_spi_dev_reset_stats(disp_spi_dev_t *dev)
+{
+    memset(&dev->stats, 0, sizeof(dev->stats));
+    dev->stats_bytes = 0;
+}
+
+uint32_t disp_spi_dev_fence(disp_spi_dev_t *dev)
+{
+    return dev->queued_seq;
+}
+
+void disp_spi_dev_wait_fence(disp_spi_dev_t *dev, uint32_t fence)
+{
+    /* queued transactions complete in order, the fence is done once no more
+     * than the ones queued after it are still in flight */
+    wait_inflight(dev, dev->queued_seq - fence);
+}
+
+/* The idle bit is set while no request is pending, every stream waiting in
+ * stream_yield wakes when it is set again, not only the first one */
+void disp_spi_priority_request(void)
+{
+    /* no display device yet, so no stream to hold back */
+    if (priority_lock == NULL) {
+        return;
+    }
+
+    xSemaphoreTake(priority_lock, portMAX_DELAY);
+    if (priority_pending++ == 0) {
+        xEventGroupClearBits(priority_idle, PRIORITY_IDLE_BIT);
+    }
+    xSemaphoreGive(priority_lock);
+}
+
+void disp_spi_priority_release(void)
+{
+    if (priority_lock == NULL) {
+        return;
+    }
+
+    xSemaphoreTake(priority_lock, portMAX_DELAY);
+    if (priority_pending > 0 && --priority_pending == 0) {
+        xEventGroupSetBits(priority_idle, PRIORITY_IDLE_BIT);
+    }
+    xSemaphoreGive(priority_lock);
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+static void dev_add_devices(disp_spi_dev_t *dev, spi_host_device_t host,
+    spi_device_interface_config_t *devcfg, int dc)
+{
+    dev->host=host;
+    dev->dc=dc;
+    dev->chained_pre_cb=devcfg->pre_cb;
+    devcfg->pre_cb=spi_pre_transfer;
+    dev->chained_post_cb=devcfg->post_cb;
+    devcfg->post_cb=spi_ready;
+
+    /* The fast and slow devices share the CS pin, it's driven by the callbacks */
+    dev->cs=devcfg->spics_io_num;
+    devcfg->spics_io_num=-1;
+    if (dev->cs >= 0) {
+        gpio_pad_select_gpio(dev->cs);
+        gpio_set_level(dev->cs, 1);
+        gpio_set_direction(dev->cs, GPIO_MODE_OUTPUT);
+    }
+
+    esp_err_t ret=spi_bus_add_device(host, devcfg, &dev->spi);
+    assert(ret==ESP_OK);
+
+    spi_device_interface_config_t slowcfg = *devcfg;
+    if (slowcfg.clock_speed_hz > SPI_TFT_SLOW_CLOCK_SPEED_HZ) {
+        slowcfg.clock_speed_hz = SPI_TFT_SLOW_CLOCK_SPEED_HZ;
+    }
+    ret=spi_bus_add_device(host, &slowcfg, &dev->spi_slow);
+    assert(ret==ESP_OK);
+
+    dev->spi_queued=dev->spi;
+}
+
+static void dev_remove_devices(disp_spi_dev_t *dev)
+{
+    /* Wait for previous pending transaction results */
+    disp_spi_dev_wait_for_pending_transactions(dev);
+
+    esp_err_t ret=spi_bus_remove_device(dev->spi);
+    assert(ret==ESP_OK);
+    ret=spi_bus_remove_device(dev->spi_slow);
+    assert(ret==ESP_OK);
+}
+
+static inline spi_device_handle_t trans_device(disp_spi_dev_t *dev, disp_spi_send_flag_t flags)
+{
+    spi_device_handle_t handle = (dev->slow_clock || (flags & DISP_SPI_CLOCK_SLOW)) ? dev->spi_slow : dev->spi;
+
+    /* the other device can't get on the bus while one holds it */
+    assert(dev->spi_acquired == NULL || dev->spi_acquired == handle);
+    return handle;
+}
+
+static void trans_fill(disp_spi_dev_t *dev, disp_spi_trans_t *t, const uint8_t *data, size_t length,
+    disp_spi_send_flag_t flags, uint8_t *out, uint64_t addr, uint8_t dummy_bits)
+{
+    memset(&t->t, 0, sizeof(t->t));
 
     /* transaction length is in bits */
-    t.base.length = length * 8;
+    t->t.base.length = length * 8;
 
     if (length <= 4 && data != NULL) {
-        t.base.flags = SPI_TRANS_USE_TXDATA;
-        memcpy(t.base.tx_data, data, length);
+        t->t.base.flags = SPI_TRANS_USE_TXDATA;
+        memcpy(t->t.base.tx_data, data, length);
     } else {
-        t.base.tx_buffer = data;
+        t->t.base.tx_buffer = data;
     }
 
     if (flags & DISP_SPI_RECEIVE) {
         assert(out != NULL && (flags & (DISP_SPI_SEND_POLLING | DISP_SPI_SEND_SYNCHRONOUS)));
-        t.base.rx_buffer = out;
+        t->t.base.rx_buffer = out;
 
 #if defined(DISP_SPI_HALF_DUPLEX)
-		t.base.rxlength = t.base.length;
-		t.base.length = 0;	/* no MOSI phase in half-duplex reads */
+		t->t.base.rxlength = t->t.base.length;
+		t->t.base.length = 0;	/* no MOSI phase in half-duplex reads */
 #else
-		t.base.rxlength = 0; /* in full-duplex mode, zero means same as tx length */
+		t->t.base.rxlength = 0; /* in full-duplex mode, zero means same as tx length */
 #endif
     }
 
     if (flags & DISP_SPI_ADDRESS_8) {
-        t.address_bits = 8;
+        t->t.address_bits = 8;
     } else if (flags & DISP_SPI_ADDRESS_16) {
-        t.address_bits = 16;
+        t->t.address_bits = 16;
     } else if (flags & DISP_SPI_ADDRESS_24) {
-        t.address_bits = 24;
+        t->t.address_bits = 24;
     } else if (flags & DISP_SPI_ADDRESS_32) {
-        t.address_bits = 32;
+        t->t.address_bits = 32;
     }
-    if (t.address_bits) {
-        t.base.addr = addr;
-        t.base.flags |= SPI_TRANS_VARIABLE_ADDR;
+    if (t->t.address_bits) {
+        t->t.base.addr = addr;
+        t->t.base.flags |= SPI_TRANS_VARIABLE_ADDR;
     }
 
 #if defined(DISP_SPI_HALF_DUPLEX)
 	if (flags & DISP_SPI_MODE_DIO) {
-		t.base.flags |= SPI_TRANS_MODE_DIO;
+		t->t.base.flags |= SPI_TRANS_MODE_DIO;
 	} else if (flags & DISP_SPI_MODE_QIO) {
-		t.base.flags |= SPI_TRANS_MODE_QIO;
+		t->t.base.flags |= SPI_TRANS_MODE_QIO;
 	}
 
 	if (flags & DISP_SPI_MODE_DIOQIO_ADDR) {
-		t.base.flags |= SPI_TRANS_MODE_DIOQIO_ADDR;
+		t->t.base.flags |= SPI_TRANS_MODE_DIOQIO_ADDR;
 	}
 
 	if ((flags & DISP_SPI_VARIABLE_DUMMY) && dummy_bits) {
-		t.dummy_bits = dummy_bits;
-		t.base.flags |= SPI_TRANS_VARIABLE_DUMMY;
+		t->t.dummy_bits = dummy_bits;
+		t->t.base.flags |= SPI_TRANS_VARIABLE_DUMMY;
 	}
 #endif
 
-    /* Save flags for pre/post transaction processing */
-    t.base.user = (void *) flags;
+    /* Save device and flags for pre/post transaction processing, the
+     * display to signal goes along in user */
+    t->dev = dev;
+    t->flags = flags;
+    t->queued = false;
+    t->t.base.user = dev->disp_drv;
+}
 
-    /* Poll/Complete/Queue transaction */
-    if (flags & DISP_SPI_SEND_POLLING) {
-		disp_wait_for_pending_transactions();	/* before polling, all previous pending transactions need to be serviced */
-        spi_device_polling_transmit(spi, (spi_transaction_t *) &t);
-    } else if (flags & DISP_SPI_SEND_SYNCHRONOUS) {
-		disp_wait_for_pending_transactions();	/* before synchronous queueing, all previous pending transactions need to be serviced */
-        spi_device_transmit(spi, (spi_transaction_t *) &t);
-    } else {
-		
-		/* if necessary, ensure we can queue new transactions by servicing some previous transactions */
-		if(uxQueueMessagesWaiting(TransactionPool) == 0) {
-			spi_transaction_t *presult;
-			while(uxQueueMessagesWaiting(TransactionPool) < SPI_TRANSACTION_POOL_RESERVE) {
-				if (spi_device_get_trans_result(spi, &presult, 1) == ESP_OK) {
-					xQueueSend(TransactionPool, &presult, portMAX_DELAY);	/* back to the pool to be reused */
-				}
-			}
-		}
+static void trans_queue(disp_spi_dev_t *dev, spi_device_handle_t handle, const disp_spi_trans_t *t,
+    const uint8_t *data, size_t length)
+{
+    /* transactions of two devices may go out in any order, drain the other one first */
+    if (handle != dev->spi_queued) {
+        disp_spi_dev_wait_for_pending_transactions(dev);
+        dev->spi_queued = handle;
+    }
 
-		spi_transaction_ext_t *pTransaction = NULL;
-		xQueueReceive(TransactionPool, &pTransaction, portMAX_DELAY);
-        memcpy(pTransaction, &t, sizeof(t));
-        if (spi_device_queue_trans(spi, (spi_transaction_t *) pTransaction, portMAX_DELAY) != ESP_OK) {
-			xQueueSend(TransactionPool, &pTransaction, portMAX_DELAY);	/* send failed transaction back to the pool to be reused */
-        }
+	disp_spi_trans_t *pTransaction = pool_pop(dev);
+
+	/* if necessary, ensure we can queue new transactions by servicing some previous transactions */
+	if (pTransaction == NULL) {
+		int64_t start = esp_timer_get_time();
+
+		dev->stats.pool_empty++;
+		do {
+			pool_reserve(dev, dev->reserve);
+			pTransaction = pool_pop(dev);
+		} while (pTransaction == NULL);
+
+		adapt_reserve(dev, esp_timer_get_time() - start);
+	}
+
+    pTransaction->t = t->t;
+    pTransaction->dev = t->dev;
+    pTransaction->flags = t->flags;
+    pTransaction->queued = true;
+
+    /* short buffers are copied, the caller is free to reuse them right away */
+    if (length > 4 && length <= DISP_SPI_INLINE_DATA_SIZE && data != NULL) {
+        memcpy(pTransaction->data, data, length);
+        pTransaction->t.base.tx_buffer = pTransaction->data;
+    }
+
+    unsigned inflight = atomic_fetch_add(&dev->inflight, 1) + 1;
+    pTransaction->depth = inflight;
+    pTransaction->queued_us = (uint32_t) esp_timer_get_time();
+    if (spi_device_queue_trans(handle, (spi_transaction_t *) pTransaction, portMAX_DELAY) != ESP_OK) {
+        atomic_fetch_sub(&dev->inflight, 1);
+		pool_push(dev, pTransaction);	/* send failed transaction back to the pool to be reused */
+        return;
+    }
+
+    dev->queued_seq++;
+    dev->stats.transactions++;
+    dev->stats_bytes += length;
+    if (inflight > dev->stats.max_inflight) {
+        dev->stats.max_inflight = inflight;
     }
 }
 
+/* Called before queueing each chunk of a pixel stream */
+static void stream_yield(disp_spi_dev_t *dev)
+{
+#if defined(SHARED_SPI_BUS)
+    /* the other devices can't get on the bus while we hold it */
+    if (dev->spi_acquired) {
+        return;
+    }
 
-void disp_wait_for_pending_transactions(void)
+    /* let the high priority requests through first */
+    xEventGroupWaitBits(priority_idle, PRIORITY_IDLE_BIT, pdFALSE, pdTRUE, portMAX_DELAY);
+
+    pool_reserve(dev, SPI_TRANSACTION_POOL_SIZE - SPI_SHARED_BUS_STREAM_INFLIGHT + 1);
+#else
+    (void) dev;
+#endif
+}
+
+/* The display to signal, the one being refreshed when none was set */
+static lv_disp_drv_t *dev_disp_drv(disp_spi_dev_t *dev)
 {
-    spi_transaction_t *presult;
+    lv_disp_t * disp = NULL;
 
-	while(uxQueueMessagesWaiting(TransactionPool) < SPI_TRANSACTION_POOL_SIZE) {	/* service until the transaction reuse pool is full again */
-        if (spi_device_get_trans_result(spi, &presult, 1) == ESP_OK) {
-			xQueueSend(TransactionPool, &presult, portMAX_DELAY);
-        }
+    if (dev->disp_drv) {
+        return dev->disp_drv;
     }
+
+#if (LVGL_VERSION_MAJOR >= 7)
+    disp = _lv_refr_get_disp_refreshing();
+#else /* Before v7 */
+    disp = lv_refr_get_disp_refreshing();
+#endif
+
+    return &disp->driver;
 }
 
-void disp_spi_acquire(void)
+/* Account a completed queued transaction and put it back in the pool */
+static void trans_done(disp_spi_dev_t *dev, disp_spi_trans_t *trans)
 {
-    esp_err_t ret = spi_device_acquire_bus(spi, portMAX_DELAY);
-    assert(ret == ESP_OK);
+    uint32_t latency_us = trans->done_us - trans->queued_us;
+
+    /* the latency covers the transactions queued ahead too, divided by the
+     * queue depth it gives the bus time of one */
+    dev->latency_x8 += latency_us - dev->latency_x8 / 8;
+    dev->service_x8 += latency_us / (trans->depth ? trans->depth : 1) - dev->service_x8 / 8;
+
+    pool_push(dev, trans);
 }
 
-void disp_spi_release(void)
+/* Create the transaction pool and fill it with ptrs to disp_spi_trans_t to reuse */
+static void pool_create(disp_spi_dev_t *dev)
 {
-    spi_device_release_bus(spi);
+    dev->pool_trans = (disp_spi_trans_t *) heap_caps_calloc(SPI_TRANSACTION_POOL_SIZE,
+        sizeof(disp_spi_trans_t), MALLOC_CAP_DMA);
+    assert(dev->pool_trans != NULL);
+
+    pool_init(dev);
+    for (size_t i = 0; i < SPI_TRANSACTION_POOL_SIZE; i++) {
+        pool_push(dev, &dev->pool_trans[i]);
+    }
+
+    dev->reserve = SPI_TRANSACTION_POOL_RESERVE;
+    dev->done = xSemaphoreCreateBinary();
+    assert(dev->done != NULL);
+
+    if (priority_lock == NULL) {
+        priority_idle = xEventGroupCreate();
+        assert(priority_idle != NULL);
+        xEventGroupSetBits(priority_idle, PRIORITY_IDLE_BIT);
+
+        priority_lock = xSemaphoreCreateMutex();
+        assert(priority_lock != NULL);
+    }
 }
 
-/**********************
- *   STATIC FUNCTIONS
- **********************/
+/* Service finished transactions until at least count slots are in the pool */
+static void pool_reserve(disp_spi_dev_t *dev, unsigned count)
+{
+    spi_transaction_t *presult;
+
+	while(pool_available(dev) < count) {
+		/* collect what is already done, then block until enough of the rest is */
+		while (spi_device_get_trans_result(dev->spi_queued, &presult, 0) == ESP_OK) {
+			trans_done(dev, (disp_spi_trans_t *) presult);	/* back to the pool to be reused */
+		}
+
+		if (pool_available(dev) < count) {
+			wait_inflight(dev, SPI_TRANSACTION_POOL_SIZE - count);
+		}
+	}
+}
+
+static void adapt_reserve(disp_spi_dev_t *dev, int64_t wait_us)
+{
+#if defined (CONFIG_LV_DISP_SPI_ADAPTIVE_POOL_RESERVE)
+    unsigned target = dev->reserve;
+    uint32_t service_us = dev->service_x8 / 8;
+
+    /* the wait just measured comes first, the latency based target after */
+    if (wait_us < SPI_ADAPTIVE_RESERVE_MIN_WAIT_US) {
+        target = dev->reserve + 1;
+    } else if (wait_us > SPI_ADAPTIVE_RESERVE_MAX_WAIT_US) {
+        target = dev->reserve - 1;
+    } else if (service_us > 0) {
+        target = SPI_ADAPTIVE_RESERVE_TARGET_WAIT_US / service_us;
+    }
+
+    if (target > dev->reserve && dev->reserve < SPI_ADAPTIVE_RESERVE_MAX) {
+        dev->reserve++;
+    } else if (target < dev->reserve && dev->reserve > 1) {
+        dev->reserve--;
+    }
+#else
+    (void) dev;
+    (void) wait_us;
+#endif
+}
+
+/* Block until at most threshold transactions are in flight */
+static void wait_inflight(disp_spi_dev_t *dev, unsigned threshold)
+{
+    dev->wait_threshold = threshold;
+    dev->waiting = true;
+    atomic_thread_fence(memory_order_seq_cst);
+
+    /* a stale give only costs one more pass of the loop */
+    while (atomic_load(&dev->inflight) > threshold) {
+        xSemaphoreTake(dev->done, portMAX_DELAY);
+    }
+
+    dev->waiting = false;
+}
+
+static void IRAM_ATTR spi_pre_transfer(spi_transaction_t *trans)
+{
+    disp_spi_trans_t *t = (disp_spi_trans_t *) trans;
+    disp_spi_dev_t *dev = t->dev;
+
+    if (dev->cs >= 0) {
+        gpio_set_level(dev->cs, 0);
+    }
+
+    if (dev->dc >= 0) {
+        if (t->flags & DISP_SPI_DC_CMD) {
+            gpio_set_level(dev->dc, 0);	/* Command mode */
+        } else if (t->flags & DISP_SPI_DC_DATA) {
+            gpio_set_level(dev->dc, 1);	/* Data mode */
+        }
+    }
+
+    if (dev->chained_pre_cb) {
+        dev->chained_pre_cb(trans);
+    }
+}
 
 static void IRAM_ATTR spi_ready(spi_transaction_t *trans)
 {
-    disp_spi_send_flag_t flags = (disp_spi_send_flag_t) trans->user;
+    disp_spi_trans_t *t = (disp_spi_trans_t *) trans;
+    disp_spi_dev_t *dev = t->dev;
+
+    if (dev->cs >= 0) {
+        gpio_set_level(dev->cs, 1);
+    }
 
-    if (flags & DISP_SPI_SIGNAL_FLUSH) {
-        lv_disp_t * disp = NULL;
+    /* polling transactions complete in the task, only the queued ones are counted */
+    if (t->queued) {
+        unsigned inflight = atomic_fetch_sub(&dev->inflight, 1) - 1;
+
+        t->done_us = (uint32_t) esp_timer_get_time();
+
+        if (dev->waiting && inflight <= dev->wait_threshold) {
+            BaseType_t woken = pdFALSE;
+            xSemaphoreGiveFromISR(dev->done, &woken);
+            if (woken == pdTRUE) {
+                portYIELD_FROM_ISR();
+            }
+        }
+    }
+
+    if (t->flags & DISP_SPI_SIGNAL_FLUSH) {
+        lv_disp_drv_t * drv = (lv_disp_drv_t *) trans->user;
+
+        /* no display was set, fall back to the one being refreshed */
+        if (drv == NULL) {
+            lv_disp_t * disp = NULL;
 
 #if (LVGL_VERSION_MAJOR >= 7)
-        disp = _lv_refr_get_disp_refreshing();
+            disp = _lv_refr_get_disp_refreshing();
 #else /* Before v7 */
-        disp = lv_refr_get_disp_refreshing();
+            disp = lv_refr_get_disp_refreshing();
 #endif
+            drv = &disp->driver;
+        }
 
-        lv_disp_flush_ready(&disp->driver);
+        lv_disp_flush_ready(drv);
     }
 
-    if (chained_post_cb) {
-        chained_post_cb(trans);
+    if (dev->chained_post_cb) {
+        dev->chained_post_cb(trans);
     }
 }
 
+static void pool_init(disp_spi_dev_t *dev)
+{
+    for (unsigned i = 0; i < SPI_TRANSACTION_RING_SIZE; i++) {
+        atomic_init(&dev->pool_cells[i].seq, i);
+        dev->pool_cells[i].trans = NULL;
+    }
+
+    atomic_init(&dev->pool_head, 0);
+    atomic_init(&dev->pool_tail, 0);
+}
+
+/* Bounded multi-producer/multi-consumer ring, never blocks so it can be
+ * used from task and ISR context alike. */
+static bool IRAM_ATTR pool_push(disp_spi_dev_t *dev, disp_spi_trans_t *trans)
+{
+    unsigned pos = atomic_load_explicit(&dev->pool_head, memory_order_relaxed);
+
+    for (;;) {
+        disp_spi_pool_cell_t *cell = &dev->pool_cells[pos & SPI_TRANSACTION_RING_MASK];
+        unsigned seq = atomic_load_explicit(&cell->seq, memory_order_acquire);
+        int diff = (int) (seq - pos);
+
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&dev->pool_head, &pos, pos + 1,
+                    memory_order_relaxed, memory_order_relaxed)) {
+                cell->trans = trans;
+                atomic_store_explicit(&cell->seq, pos + 1, memory_order_release);
+                return true;
+            }
+        } else if (diff < 0) {
+            return false;   /* ring is full */
+        } else {
+            pos = atomic_load_explicit(&dev->pool_head, memory_order_relaxed);
+        }
+    }
+}
+
+static disp_spi_trans_t * IRAM_ATTR pool_pop(disp_spi_dev_t *dev)
+{
+    unsigned pos = atomic_load_explicit(&dev->pool_tail, memory_order_relaxed);
+
+    for (;;) {
+        disp_spi_pool_cell_t *cell = &dev->pool_cells[pos & SPI_TRANSACTION_RING_MASK];
+        unsigned seq = atomic_load_explicit(&cell->seq, memory_order_acquire);
+        int diff = (int) (seq - (pos + 1));
+
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&dev->pool_tail, &pos, pos + 1,
+                    memory_order_relaxed, memory_order_relaxed)) {
+                disp_spi_trans_t *trans = cell->trans;
+                atomic_store_explicit(&cell->seq, pos + SPI_TRANSACTION_RING_SIZE, memory_order_release);
+                return trans;
+            }
+        } else if (diff < 0) {
+            return NULL;    /* ring is empty */
+        } else {
+            pos = atomic_load_explicit(&dev->pool_tail, memory_order_relaxed);
+        }
+    }
+}
+
+/* Number of free transactions in the pool */
+static inline unsigned pool_available(disp_spi_dev_t *dev)
+{
+    unsigned tail = atomic_load_explicit(&dev->pool_tail, memory_order_acquire);
+
+    return atomic_load_explicit(&dev->pool_head, memory_order_acquire) - tail;
+}
@@ -20,6 +20,9 @@ extern "C" {
 /*********************
  *      DEFINES
  *********************/
+/* Queued transactions up to this many bytes are copied into the transaction
+ * pool, so the caller's buffer may go out of scope right after queueing. */
+#define DISP_SPI_INLINE_DATA_SIZE   32
 
 /**********************
  *      TYPEDEFS
@@ -40,8 +43,35 @@ typedef enum _disp_spi_send_flag_t {
     DISP_SPI_MODE_QIO           = 0x00000800, 
     DISP_SPI_MODE_DIOQIO_ADDR   = 0x00001000, 
 	DISP_SPI_VARIABLE_DUMMY		= 0x00002000,
+    DISP_SPI_DC_CMD             = 0x00004000, /* DC line low (command) during the transaction */
+    DISP_SPI_DC_DATA            = 0x00008000, /* DC line high (data) during the transaction */
+    DISP_SPI_CLOCK_SLOW         = 0x00010000, /* send at SPI_TFT_SLOW_CLOCK_SPEED_HZ */
 } disp_spi_send_flag_t;
 
+/* Handle of a display on a SPI host, see disp_spi_dev_create() */
+typedef struct _disp_spi_dev_t disp_spi_dev_t;
+
+struct _disp_drv_t;
+
+/* Queued transaction counters, to tune the transaction pool */
+typedef struct {
+    uint32_t transactions;          /* queued transactions */
+    uint32_t avg_transaction_size;  /* bytes */
+    uint32_t pool_empty;            /* times queueing had to wait for a free transaction */
+    uint32_t max_inflight;          /* deepest queue seen */
+    uint32_t reserve;               /* current pool reserve */
+    uint32_t avg_latency_us;        /* recent queue to completion time */
+} disp_spi_stats_t;
+
+/* One transaction of a batch, the DC level is selected with DISP_SPI_DC_CMD
+ * or DISP_SPI_DC_DATA in flags. Each segment must fit in a single transaction. */
+typedef struct {
+    const uint8_t *data;
+    size_t length;
+    disp_spi_send_flag_t flags;
+    uint64_t addr;
+} disp_spi_segment_t;
+
 
 /**********************
  * GLOBAL PROTOTYPES
@@ -51,6 +81,10 @@ void disp_spi_add_device_config(spi_host_device_t host, spi_device_interface_con
 void disp_spi_add_device_with_speed(spi_host_device_t host, int clock_speed_hz);
 void disp_spi_change_device_speed(int clock_speed_hz);
 void disp_spi_remove_device();
+/* Send the transactions not flagged with DISP_SPI_CLOCK_SLOW at the slow clock too */
+void disp_spi_use_slow_clock(bool slow);
+/* Display signaled by DISP_SPI_SIGNAL_FLUSH, the display being refreshed when NULL */
+void disp_spi_set_disp_drv(struct _disp_drv_t *drv);
 
 /*	Important! 
 	All buffers should also be 32-bit aligned and DMA capable to prevent extra allocations and copying.
@@ -60,20 +94,86 @@ void disp_spi_remove_device();
 void disp_spi_transaction(const uint8_t *data, size_t length,
     disp_spi_send_flag_t flags, uint8_t *out, uint64_t addr, uint8_t dummy_bits);
 
+/* Send a buffer of any length, split into chunks no bigger than the SPI bus
+   maximum transfer size. The chunks are sent back-to-back with the same flags
+   and address, DISP_SPI_SIGNAL_FLUSH is only raised by the last one. */
+void disp_spi_transaction_stream(const uint8_t *data, size_t length,
+    disp_spi_send_flag_t flags, uint64_t addr);
+
+/* Queue a list of segments in one pass. The segment flags only select the
+   address, mode and DC line, the batch flags select how it is sent:
+   DISP_SPI_SEND_POLLING or DISP_SPI_SEND_SYNCHRONOUS wait for the whole batch
+   to complete and DISP_SPI_SIGNAL_FLUSH is raised once, by the last segment
+   with data, or right away when there is none. Empty segments are skipped.
+   Segments of up to DISP_SPI_INLINE_DATA_SIZE bytes are copied. */
+void disp_spi_transaction_batch(const disp_spi_segment_t *segs, size_t count,
+    disp_spi_send_flag_t flags);
+
 void disp_wait_for_pending_transactions(void);
 void disp_spi_acquire(void);
 void disp_spi_release(void);
+void disp_spi_get_stats(disp_spi_stats_t *stats);
+void disp_spi_reset_stats(void);
+
+/* Fences for reusing a buffer handed to a queued transaction: the fence of
+   the last queued transaction, and a wait until it completed. */
+uint32_t disp_spi_fence(void);
+void disp_spi_wait_fence(uint32_t fence);
+
+/* High priority access to a shared bus (touch samples, register reads).
+   While requested, pixel streams stop queueing chunks until released. */
+void disp_spi_priority_request(void);
+void disp_spi_priority_release(void);
+
+/* Instances, for driving more than one display. The dc pin is set up as an
+   output, -1 if the display has no DC line. The functions match the ones
+   above working on the default instance. */
+disp_spi_dev_t *disp_spi_dev_create(spi_host_device_t host, spi_device_interface_config_t *devcfg, int dc);
+void disp_spi_dev_delete(disp_spi_dev_t *dev);
+void disp_spi_dev_use_slow_clock(disp_spi_dev_t *dev, bool slow);
+void disp_spi_dev_set_disp_drv(disp_spi_dev_t *dev, struct _disp_drv_t *drv);
+void disp_spi_dev_transaction(disp_spi_dev_t *dev, const uint8_t *data, size_t length,
+    disp_spi_send_flag_t flags, uint8_t *out, uint64_t addr, uint8_t dummy_bits);
+void disp_spi_dev_transaction_batch(disp_spi_dev_t *dev, const disp_spi_segment_t *segs, size_t count,
+    disp_spi_send_flag_t flags);
+void disp_spi_dev_transaction_stream(disp_spi_dev_t *dev, const uint8_t *data, size_t length,
+    disp_spi_send_flag_t flags, uint64_t addr);
+void disp_spi_dev_wait_for_pending_transactions(disp_spi_dev_t *dev);
+void disp_spi_dev_acquire(disp_spi_dev_t *dev);
+void disp_spi_dev_release(disp_spi_dev_t *dev);
+void disp_spi_dev_get_stats(disp_spi_dev_t *dev, disp_spi_stats_t *stats);
+void disp_spi_dev_reset_stats(disp_spi_dev_t *dev);
+uint32_t disp_spi_dev_fence(disp_spi_dev_t *dev);
+void disp_spi_dev_wait_fence(disp_spi_dev_t *dev, uint32_t fence);
 
 static inline void disp_spi_send_data(uint8_t *data, size_t length) {
     disp_spi_transaction(data, length, DISP_SPI_SEND_POLLING, NULL, 0, 0);
 }
 
 static inline void disp_spi_send_colors(uint8_t *data, size_t length) {
+    disp_spi_transaction_stream(data, length,
+        DISP_SPI_SEND_QUEUED | DISP_SPI_SIGNAL_FLUSH, 0);
+}
+
+/* Queued command/data helpers for displays using a DC line, the DC level
+ * is set by the pre transfer callback so no draining is needed in between. */
+static inline void disp_spi_send_cmd(uint8_t cmd) {
+    disp_spi_transaction(&cmd, 1,
+        DISP_SPI_SEND_QUEUED | DISP_SPI_DC_CMD,
+        NULL, 0, 0);
+}
+
+static inline void disp_spi_send_params(const uint8_t *data, size_t length) {
     disp_spi_transaction(data, length,
-        DISP_SPI_SEND_QUEUED | DISP_SPI_SIGNAL_FLUSH,
+        DISP_SPI_SEND_QUEUED | DISP_SPI_DC_DATA,
         NULL, 0, 0);
 }
 
+static inline void disp_spi_send_pixels(const uint8_t *data, size_t length) {
+    disp_spi_transaction_stream(data, length,
+        DISP_SPI_SEND_QUEUED | DISP_SPI_DC_DATA | DISP_SPI_SIGNAL_FLUSH, 0);
+}
+
 #ifdef __cplusplus
 } /* extern "C" */
 #endif
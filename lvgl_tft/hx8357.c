@@ -17,6 +17,7 @@
  *********************/
 #include "hx8357.h"
 #include "disp_spi.h"
+#include "disp_mipi.h"
 #include "driver/gpio.h"
 #include <esp_log.h>
 #include "freertos/FreeRTOS.h"
@@ -39,20 +40,9 @@
  *      TYPEDEFS
  **********************/
 
-/*The LCD needs a bunch of command/argument values to be initialized. They are stored in this struct. */
-typedef struct {
-    uint8_t cmd;
-    uint8_t data[16];
-    uint8_t databytes; //No of data in data; bit 7 = delay after set; 0xFF = end of cmds.
-} lcd_init_cmd_t;
-
 /**********************
  *  STATIC PROTOTYPES
  **********************/
-static void hx8357_send_cmd(uint8_t cmd);
-static void hx8357_send_data(void * data, uint16_t length);
-static void hx8357_send_color(void * data, uint16_t length);
-
 
 /**********************
  *  INITIALIZATION ARRAYS
@@ -147,6 +137,20 @@ static const uint8_t
 /**********************
  *  STATIC VARIABLES
  **********************/
+static const disp_mipi_panel_t hx8357_panel = {
+	.name = TAG,
+	/* hx8357_set_rotation(1) whatever the orientation */
+	.madctl = {
+		MADCTL_MV | MADCTL_MY | MADCTL_RGB, MADCTL_MV | MADCTL_MY | MADCTL_RGB,
+		MADCTL_MV | MADCTL_MY | MADCTL_RGB, MADCTL_MV | MADCTL_MY | MADCTL_RGB,
+	},
+	.bytes_per_pixel = 2,
+#if HX8357_INVERT_COLORS
+	.inversion = DISP_MIPI_INVERSION_ON,
+#else
+	.inversion = DISP_MIPI_INVERSION_OFF,
+#endif
+};
 
 /**********************
  *      MACROS
@@ -176,9 +180,7 @@ void hx8357_init(void)
 	gpio_set_level(HX8357_RST, 1);
 	vTaskDelay(120 / portTICK_RATE_MS);
 
-	ESP_LOGI(TAG, "Initialization.");
-
-	//Send all the commands
+	//Send all the commands, the init lists don't fit disp_mipi_init_cmd_t
 	const uint8_t *addr = (displayType == HX8357B) ? initb : initd;
 	uint8_t        cmd, x, numArgs;
 	while((cmd = *addr++) > 0) { // '0' command ends list
@@ -186,25 +188,20 @@ void hx8357_init(void)
 		numArgs = x & 0x7F;
 		if (cmd != 0xFF) { // '255' is ignored
 			if (x & 0x80) {  // If high bit set, numArgs is a delay time
-				hx8357_send_cmd(cmd);
+				disp_mipi_send_cmd(cmd);
 			} else {
-				hx8357_send_cmd(cmd);
-				hx8357_send_data((void *) addr, numArgs);
+				disp_mipi_send_cmd(cmd);
+				disp_mipi_send_params(addr, numArgs);
 				addr += numArgs;
 			}
 		}
 		if (x & 0x80) {       // If high bit set...
+			disp_wait_for_pending_transactions();
 			vTaskDelay(numArgs * 5 / portTICK_RATE_MS); // numArgs is actually a delay time (5ms units)
 		}
 	}
 
-	hx8357_set_rotation(1);
-
-#if HX8357_INVERT_COLORS
-	hx8357_send_cmd(HX8357_INVON);
-#else
-    hx8357_send_cmd(HX8357_INVOFF);
-#endif
+	disp_mipi_init(&hx8357_panel);
 
 	hx8357_enable_backlight(true);
 }
@@ -212,35 +209,7 @@ void hx8357_init(void)
 
 void hx8357_flush(lv_disp_drv_t * drv, const lv_area_t * area, lv_color_t * color_map)
 {
-	uint32_t size = lv_area_get_width(area) * lv_area_get_height(area);
-
-	/* Column addresses  */
-	uint8_t xb[] = {
-	    (uint8_t) (area->x1 >> 8) & 0xFF,
-	    (uint8_t) (area->x1) & 0xFF,
-	    (uint8_t) (area->x2 >> 8) & 0xFF,
-	    (uint8_t) (area->x2) & 0xFF,
-	};
-
-	/* Page addresses  */
-	uint8_t yb[] = {
-	    (uint8_t) (area->y1 >> 8) & 0xFF,
-	    (uint8_t) (area->y1) & 0xFF,
-	    (uint8_t) (area->y2 >> 8) & 0xFF,
-	    (uint8_t) (area->y2) & 0xFF,
-	};
-
-	/*Column addresses*/
-	hx8357_send_cmd(HX8357_CASET);
-	hx8357_send_data(xb, 4);
-
-	/*Page addresses*/
-	hx8357_send_cmd(HX8357_PASET);
-	hx8357_send_data(yb, 4);
-
-	/*Memory write*/
-	hx8357_send_cmd(HX8357_RAMWR);
-	hx8357_send_color((void*)color_map, size * 2);
+	disp_mipi_flush(drv, area, color_map);
 }
 
 void hx8357_enable_backlight(bool backlight)
@@ -279,34 +248,10 @@ void hx8357_set_rotation(uint8_t r)
 		break;
 	}
 
-	hx8357_send_cmd(HX8357_MADCTL);
-	hx8357_send_data(&r, 1);
+	disp_mipi_send_cmd(HX8357_MADCTL);
+	disp_mipi_send_params(&r, 1);
 }
 
 /**********************
  *   STATIC FUNCTIONS
  **********************/
-
-
-static void hx8357_send_cmd(uint8_t cmd)
-{
-	disp_wait_for_pending_transactions();
-	gpio_set_level(HX8357_DC, 0);	 /*Command mode*/
-	disp_spi_send_data(&cmd, 1);
-}
-
-
-static void hx8357_send_data(void * data, uint16_t length)
-{
-	disp_wait_for_pending_transactions();
-	gpio_set_level(HX8357_DC, 1);	 /*Data mode*/
-	disp_spi_send_data(data, length);
-}
-
-
-static void hx8357_send_color(void * data, uint16_t length)
-{
-	disp_wait_for_pending_transactions();
-	gpio_set_level(HX8357_DC, 1);   /*Data mode*/
-	disp_spi_send_colors(data, length);
-}
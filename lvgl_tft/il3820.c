@@ -35,6 +35,7 @@ TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR TH
 #include "freertos/task.h"
 
 #include "il3820.h"
+#include "disp_pixconv.h"
 
 /*********************
  *      DEFINES
@@ -45,9 +46,6 @@ TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR TH
  * SSD1673, SSD1608 compatible EPD controller driver.
  */
 
-#define BIT_SET(a,b)                    ((a) |= (1U<<(b)))
-#define BIT_CLEAR(a,b)                  ((a) &= ~(1U<<(b)))
-
 /* Number of pixels? */
 #define IL3820_PIXEL                    (LV_HOR_RES_MAX * LV_VER_RES_MAX)
 
@@ -97,7 +95,7 @@ static inline void il3820_command_mode(void);
 static inline void il3820_data_mode(void);
 static inline void il3820_write_cmd(uint8_t cmd, uint8_t *data, size_t len);
 static inline void il3820_send_cmd(uint8_t cmd);
-static void il3820_send_data(uint8_t *data, uint16_t length);
+static void il3820_send_data(uint8_t *data, size_t length);
 static inline void il3820_set_window( uint16_t sx, uint16_t ex, uint16_t ys, uint16_t ye);
 static inline void il3820_set_cursor(uint16_t sx, uint16_t ys);
 static void il3820_update_display(void);
@@ -149,36 +147,20 @@ void il3820_flush(lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t *color_m
 
 
 /* Rotate the display by "software" when using PORTRAIT orientation.
- * BIT_SET(byte_index, bit_index) clears the bit_index pixel at byte_index of
- * the display buffer.
- * BIT_CLEAR(byte_index, bit_index) sets the bit_index pixel at the byte_index
- * of the display buffer. */ 		
+ * A set bit clears the pixel of the display buffer, a cleared bit sets it,
+ * the pages are filled from bit 7 down. */
 void il3820_set_px_cb(lv_disp_drv_t * disp_drv, uint8_t* buf,
     lv_coord_t buf_w, lv_coord_t x, lv_coord_t y,
     lv_color_t color, lv_opa_t opa)
 {
-    uint16_t byte_index = 0;
-    uint8_t  bit_index = 0;
-
 #if defined (CONFIG_LV_DISPLAY_ORIENTATION_PORTRAIT)
-    byte_index = x + ((y >> 3) * EPD_PANEL_HEIGHT);
-    bit_index  = y & 0x7;
-
     if (color.full) {
-        BIT_SET(buf[byte_index], 7 - bit_index);
+        disp_pixconv_mono_page_set_msb(buf, EPD_PANEL_HEIGHT, x, y, true);
     } else {
-        uint16_t mirrored_idx = (EPD_PANEL_HEIGHT - x) + ((y >> 3) * EPD_PANEL_HEIGHT);
-        BIT_CLEAR(buf[mirrored_idx], 7 - bit_index);
+        disp_pixconv_mono_page_set_msb(buf, EPD_PANEL_HEIGHT, EPD_PANEL_HEIGHT - x, y, false);
     }
 #elif defined (CONFIG_LV_DISPLAY_ORIENTATION_LANDSCAPE)
-    byte_index = y + ((x >> 3) * EPD_PANEL_HEIGHT);
-    bit_index  = x & 0x7;
-
-    if (color.full) {
-        BIT_SET(buf[byte_index], 7 - bit_index);
-    } else {
-        BIT_CLEAR(buf[byte_index], 7 - bit_index);
-    }
+    disp_pixconv_mono_page_set_msb(buf, EPD_PANEL_HEIGHT, y, x, color.full);
 #else
 #error "Unsupported orientation used"
 #endif
@@ -310,13 +292,16 @@ static inline void il3820_send_cmd(uint8_t cmd)
     disp_spi_send_data(&cmd, 1);
 }
 
-/* Send length bytes of data to the display */
-static void il3820_send_data(uint8_t *data, uint16_t length)
+/* Send length bytes of data to the display
+ *
+ * Pixel data doesn't signal the flush, lv_disp_flush_ready is called once
+ * the display update is done. */
+static void il3820_send_data(uint8_t *data, size_t length)
 {
     disp_wait_for_pending_transactions();
     
     il3820_data_mode();
-    disp_spi_send_colors(data, length);
+    disp_spi_transaction(data, length, DISP_SPI_SEND_QUEUED, NULL, 0, 0);
 }
 
 /* Specify the start/end positions of the window address in the X and Y
@@ -8,6 +8,7 @@
  *********************/
 #include "ili9341.h"
 #include "disp_spi.h"
+#include "disp_mipi.h"
 #include "driver/gpio.h"
 #include "esp_log.h"
 #include "freertos/FreeRTOS.h"
@@ -22,25 +23,59 @@
  *      TYPEDEFS
  **********************/
 
-/*The LCD needs a bunch of command/argument values to be initialized. They are stored in this struct. */
-typedef struct {
-    uint8_t cmd;
-    uint8_t data[16];
-    uint8_t databytes; //No of data in data; bit 7 = delay after set; 0xFF = end of cmds.
-} lcd_init_cmd_t;
-
 /**********************
  *  STATIC PROTOTYPES
  **********************/
-static void ili9341_set_orientation(uint8_t orientation);
-
-static void ili9341_send_cmd(uint8_t cmd);
-static void ili9341_send_data(void * data, uint16_t length);
-static void ili9341_send_color(void * data, uint16_t length);
 
 /**********************
  *  STATIC VARIABLES
  **********************/
+static const disp_mipi_init_cmd_t ili9341_init_cmds[] = {
+	{0xCF, {0x00, 0x83, 0X30}, 3},
+	{0xED, {0x64, 0x03, 0X12, 0X81}, 4},
+	{0xE8, {0x85, 0x01, 0x79}, 3},
+	{0xCB, {0x39, 0x2C, 0x00, 0x34, 0x02}, 5},
+	{0xF7, {0x20}, 1},
+	{0xEA, {0x00, 0x00}, 2},
+	{0xC0, {0x26}, 1},          /*Power control*/
+	{0xC1, {0x11}, 1},          /*Power control */
+	{0xC5, {0x35, 0x3E}, 2},    /*VCOM control*/
+	{0xC7, {0xBE}, 1},          /*VCOM control*/
+	{0x36, {0x28}, 1},          /*Memory Access Control*/
+	{0x3A, {0x55}, 1},			/*Pixel Format Set*/
+	{0xB1, {0x00, 0x1B}, 2},
+	{0xF2, {0x08}, 1},
+	{0x26, {0x01}, 1},
+	{0xE0, {0x1F, 0x1A, 0x18, 0x0A, 0x0F, 0x06, 0x45, 0X87, 0x32, 0x0A, 0x07, 0x02, 0x07, 0x05, 0x00}, 15},
+	{0XE1, {0x00, 0x25, 0x27, 0x05, 0x10, 0x09, 0x3A, 0x78, 0x4D, 0x05, 0x18, 0x0D, 0x38, 0x3A, 0x1F}, 15},
+	{0x2A, {0x00, 0x00, 0x00, 0xEF}, 4},
+	{0x2B, {0x00, 0x00, 0x01, 0x3f}, 4},
+	{0x2C, {0}, 0},
+	{0xB7, {0x07}, 1},
+	{0xB6, {0x0A, 0x82, 0x27, 0x00}, 4},
+	{0x11, {0}, 0, 5},
+	{0x29, {0}, 0},
+	{0, {0}, DISP_MIPI_INIT_END},
+};
+
+static const disp_mipi_panel_t ili9341_panel = {
+    .name = TAG,
+    .init_cmds = ili9341_init_cmds,
+#if defined CONFIG_LV_PREDEFINED_DISPLAY_M5STACK
+    .madctl = {0x68, 0x68, 0x08, 0x08},
+#elif defined (CONFIG_LV_PREDEFINED_DISPLAY_WROVER4)
+    .madctl = {0x4C, 0x88, 0x28, 0xE8},
+#elif defined (CONFIG_LV_PREDEFINED_DISPLAY_NONE)
+    .madctl = {0x48, 0x88, 0x28, 0xE8},
+#endif
+    .bytes_per_pixel = 2,
+    .memory_lines = 320,
+#if ILI9341_INVERT_COLORS == 1
+    .inversion = DISP_MIPI_INVERSION_ON,
+#else
+    .inversion = DISP_MIPI_INVERSION_OFF,
+#endif
+};
 
 /**********************
  *      MACROS
@@ -52,34 +87,6 @@ static void ili9341_send_color(void * data, uint16_t length);
 
 void ili9341_init(void)
 {
-	lcd_init_cmd_t ili_init_cmds[]={
-		{0xCF, {0x00, 0x83, 0X30}, 3},
-		{0xED, {0x64, 0x03, 0X12, 0X81}, 4},
-		{0xE8, {0x85, 0x01, 0x79}, 3},
-		{0xCB, {0x39, 0x2C, 0x00, 0x34, 0x02}, 5},
-		{0xF7, {0x20}, 1},
-		{0xEA, {0x00, 0x00}, 2},
-		{0xC0, {0x26}, 1},          /*Power control*/
-		{0xC1, {0x11}, 1},          /*Power control */
-		{0xC5, {0x35, 0x3E}, 2},    /*VCOM control*/
-		{0xC7, {0xBE}, 1},          /*VCOM control*/
-		{0x36, {0x28}, 1},          /*Memory Access Control*/
-		{0x3A, {0x55}, 1},			/*Pixel Format Set*/
-		{0xB1, {0x00, 0x1B}, 2},
-		{0xF2, {0x08}, 1},
-		{0x26, {0x01}, 1},
-		{0xE0, {0x1F, 0x1A, 0x18, 0x0A, 0x0F, 0x06, 0x45, 0X87, 0x32, 0x0A, 0x07, 0x02, 0x07, 0x05, 0x00}, 15},
-		{0XE1, {0x00, 0x25, 0x27, 0x05, 0x10, 0x09, 0x3A, 0x78, 0x4D, 0x05, 0x18, 0x0D, 0x38, 0x3A, 0x1F}, 15},
-		{0x2A, {0x00, 0x00, 0x00, 0xEF}, 4},
-		{0x2B, {0x00, 0x00, 0x01, 0x3f}, 4},
-		{0x2C, {0}, 0},
-		{0xB7, {0x07}, 1},
-		{0xB6, {0x0A, 0x82, 0x27, 0x00}, 4},
-		{0x11, {0}, 0x80},
-		{0x29, {0}, 0x80},
-		{0, {0}, 0xff},
-	};
-
 #if ILI9341_BCKL == 15
 	gpio_config_t io_conf;
     io_conf.intr_type = GPIO_PIN_INTR_DISABLE;
@@ -101,63 +108,17 @@ void ili9341_init(void)
     gpio_set_direction(ILI9341_BCKL, GPIO_MODE_OUTPUT);
 #endif
 	//Reset the display
-	gpio_set_level(ILI9341_RST, 0);
-	vTaskDelay(100 / portTICK_PERIOD_MS);
-	gpio_set_level(ILI9341_RST, 1);
-	vTaskDelay(100 / portTICK_PERIOD_MS);
-
-	ESP_LOGI(TAG, "Initialization.");
-
-	//Send all the commands
-	uint16_t cmd = 0;
-	while (ili_init_cmds[cmd].databytes!=0xff) {
-		ili9341_send_cmd(ili_init_cmds[cmd].cmd);
-		ili9341_send_data(ili_init_cmds[cmd].data, ili_init_cmds[cmd].databytes&0x1F);
-		if (ili_init_cmds[cmd].databytes & 0x80) {
-			vTaskDelay(100 / portTICK_PERIOD_MS);
-		}
-		cmd++;
-	}
+	disp_mipi_reset(ILI9341_RST);
 
-	ili9341_enable_backlight(true);
+	disp_mipi_init(&ili9341_panel);
 
-        ili9341_set_orientation(CONFIG_LV_DISPLAY_ORIENTATION);
-
-#if ILI9341_INVERT_COLORS == 1
-	ili9341_send_cmd(0x21);
-#else
-	ili9341_send_cmd(0x20);
-#endif
+	ili9341_enable_backlight(true);
 }
 
 
 void ili9341_flush(lv_disp_drv_t * drv, const lv_area_t * area, lv_color_t * color_map)
 {
-	uint8_t data[4];
-
-	/*Column addresses*/
-	ili9341_send_cmd(0x2A);
-	data[0] = (area->x1 >> 8) & 0xFF;
-	data[1] = area->x1 & 0xFF;
-	data[2] = (area->x2 >> 8) & 0xFF;
-	data[3] = area->x2 & 0xFF;
-	ili9341_send_data(data, 4);
-
-	/*Page addresses*/
-	ili9341_send_cmd(0x2B);
-	data[0] = (area->y1 >> 8) & 0xFF;
-	data[1] = area->y1 & 0xFF;
-	data[2] = (area->y2 >> 8) & 0xFF;
-	data[3] = area->y2 & 0xFF;
-	ili9341_send_data(data, 4);
-
-	/*Memory write*/
-	ili9341_send_cmd(0x2C);
-
-
-	uint32_t size = lv_area_get_width(area) * lv_area_get_height(area);
-
-	ili9341_send_color((void*)color_map, size * 2);
+	disp_mipi_flush(drv, area, color_map);
 }
 
 void ili9341_enable_backlight(bool backlight)
@@ -179,63 +140,32 @@ void ili9341_enable_backlight(bool backlight)
 void ili9341_sleep_in()
 {
 	uint8_t data[] = {0x08};
-	ili9341_send_cmd(0x10);
-	ili9341_send_data(&data, 1);
+	disp_mipi_send_cmd(DISP_MIPI_SLPIN);
+	disp_mipi_send_params(data, 1);
 }
 
 void ili9341_sleep_out()
 {
 	uint8_t data[] = {0x08};
-	ili9341_send_cmd(0x11);
-	ili9341_send_data(&data, 1);
+	disp_mipi_send_cmd(DISP_MIPI_SLPOUT);
+	disp_mipi_send_params(data, 1);
 }
 
-/**********************
- *   STATIC FUNCTIONS
- **********************/
-
-
-static void ili9341_send_cmd(uint8_t cmd)
+bool ili9341_scroll_init(uint16_t top_fixed, uint16_t bottom_fixed)
 {
-    disp_wait_for_pending_transactions();
-    gpio_set_level(ILI9341_DC, 0);	 /*Command mode*/
-    disp_spi_send_data(&cmd, 1);
+	return disp_mipi_scroll_init(top_fixed, bottom_fixed);
 }
 
-static void ili9341_send_data(void * data, uint16_t length)
+void ili9341_scroll(lv_coord_t dy, lv_area_t *exposed)
 {
-    disp_wait_for_pending_transactions();
-    gpio_set_level(ILI9341_DC, 1);	 /*Data mode*/
-    disp_spi_send_data(data, length);
+	disp_mipi_scroll(dy, exposed);
 }
 
-static void ili9341_send_color(void * data, uint16_t length)
+void ili9341_scroll_stop(void)
 {
-    disp_wait_for_pending_transactions();
-    gpio_set_level(ILI9341_DC, 1);   /*Data mode*/
-    disp_spi_send_colors(data, length);
+	disp_mipi_scroll_stop();
 }
 
-static void ili9341_set_orientation(uint8_t orientation)
-{
-    // ESP_ASSERT(orientation < 4);
-
-    const char *orientation_str[] = {
-        "PORTRAIT", "PORTRAIT_INVERTED", "LANDSCAPE", "LANDSCAPE_INVERTED"
-    };
-
-    ESP_LOGI(TAG, "Display orientation: %s", orientation_str[orientation]);
-
-#if defined CONFIG_LV_PREDEFINED_DISPLAY_M5STACK
-    uint8_t data[] = {0x68, 0x68, 0x08, 0x08};
-#elif defined (CONFIG_LV_PREDEFINED_DISPLAY_WROVER4)
-    uint8_t data[] = {0x4C, 0x88, 0x28, 0xE8};
-#elif defined (CONFIG_LV_PREDEFINED_DISPLAY_NONE)
-    uint8_t data[] = {0x48, 0x88, 0x28, 0xE8};
-#endif
-
-    ESP_LOGI(TAG, "0x36 command value: 0x%02X", data[orientation]);
-
-    ili9341_send_cmd(0x36);
-    ili9341_send_data((void *) &data[orientation], 1);
-}
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
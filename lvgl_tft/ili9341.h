@@ -52,6 +52,10 @@ void ili9341_flush(lv_disp_drv_t * drv, const lv_area_t * area, lv_color_t * col
 void ili9341_enable_backlight(bool backlight);
 void ili9341_sleep_in(void);
 void ili9341_sleep_out(void);
+/* Hardware vertical scrolling, see disp_mipi_scroll_init() */
+bool ili9341_scroll_init(uint16_t top_fixed, uint16_t bottom_fixed);
+void ili9341_scroll(lv_coord_t dy, lv_area_t *exposed);
+void ili9341_scroll_stop(void);
 
 /**********************
  *      MACROS
@@ -155,6 +155,10 @@ typedef struct {
 void ili9488_init(void);
 void ili9488_flush(lv_disp_drv_t * drv, const lv_area_t * area, lv_color_t * color_map);
 void ili9488_enable_backlight(bool backlight);
+/* Hardware vertical scrolling, see disp_mipi_scroll_init() */
+bool ili9488_scroll_init(uint16_t top_fixed, uint16_t bottom_fixed);
+void ili9488_scroll(lv_coord_t dy, lv_area_t *exposed);
+void ili9488_scroll_stop(void);
 
 /**********************
  *      MACROS
@@ -32,6 +32,7 @@ TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR TH
 #include <esp_log.h>
 
 #include "disp_spi.h"
+#include "disp_pixconv.h"
 #include "jd79653a.h"
 
 #define TAG "lv_jd79653a"
@@ -48,9 +49,6 @@ TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR TH
 #define EPD_ROW_LEN         (EPD_HEIGHT / 8u)
 #define EPD_PARTIAL_CNT     5;
 
-#define BIT_SET(a, b)       ((a) |= (1U << (b)))
-#define BIT_CLEAR(a, b)     ((a) &= ~(1U << (b)))
-
 static uint8_t partial_counter = 0;
 
 typedef struct
@@ -180,7 +178,7 @@ static void jd79653a_spi_send_fb(uint8_t *data, size_t len)
 {
     disp_wait_for_pending_transactions();
     gpio_set_level(PIN_DC, 1);   // DC = 1 for data
-    disp_spi_send_colors(data, len);
+    disp_spi_transaction(data, len, DISP_SPI_SEND_QUEUED, NULL, 0, 0);  // flush is signaled after the refresh
 }
 
 static void jd79653a_spi_send_seq(const jd79653a_seq_t *seq, size_t len)
@@ -384,14 +382,7 @@ void jd79653a_fb_full_update(uint8_t *data, size_t len)
 void jd79653a_lv_set_fb_cb(struct _disp_drv_t *disp_drv, uint8_t *buf, lv_coord_t buf_w, lv_coord_t x, lv_coord_t y,
                            lv_color_t color, lv_opa_t opa)
 {
-    uint16_t byte_index = (x >> 3u) + (y * EPD_ROW_LEN);
-    uint8_t bit_index = x & 0x07u;
-
-    if (color.full) {
-        BIT_SET(buf[byte_index], 7 - bit_index);
-    } else {
-        BIT_CLEAR(buf[byte_index], 7 - bit_index);
-    }
+    disp_pixconv_mono_row_set(buf, EPD_ROW_LEN, x, y, color.full);
 }
 
 void jd79653a_lv_rounder_cb(struct _disp_drv_t *disp_drv, lv_area_t *area)
@@ -11,6 +11,7 @@
 #include "esp_log.h"
 #include "lvgl.h"
 #include "nv6001.h"
+#include "disp_pixconv.h"
 
 /**********************
  *  STATIC PROTOTYPES
@@ -210,20 +211,6 @@ static void nv6001_set_orientation(uint8_t orientation)
 	esp_lcd_panel_io_tx_param(lcd_io_handle, 0x36, (void *)&data[orientation], 1);
 }
 
-uint8_t *rev_color_map(uint8_t *color_map, size_t size)
-{
-	// 高低取反
-	uint8_t *data = (uint8_t *)malloc(size * 2);
-
-	for (size_t x = 0; x < size * 2; x += 2)
-	{
-		data[x] = color_map[x + 1];
-		data[x + 1] = color_map[x];
-	}
-	free(data);
-	return data;
-}
-
 void set_col_page(int x1, int x2, int y1, int y2)
 {
 	// CASET (2Ah): Column Address Set
@@ -253,61 +240,37 @@ void set_col_page(int x1, int x2, int y1, int y2)
 	esp_lcd_panel_io_tx_param(lcd_io_handle, LCD_CMD_RAMWR, NULL, 0);
 }
 
+void nv6001_rounder(lv_disp_drv_t *drv, lv_area_t *area)
+{
+	// The panel is rotated, LVGL x runs along the panel columns whose start
+	// and count must be multiples of 4 (see set_col_page)
+	area->x1 &= ~3;
+	area->x2 |= 3;
+	if (area->x2 >= ROW)
+		area->x2 = ROW - 1;
+}
+
 void nv6001_flush(lv_disp_drv_t *drv, const lv_area_t *area, uint8_t *color_map)
 {
+	static bool unaligned_logged = false;
 	uint16_t x1 = area->y1;
 	uint16_t x2 = area->y2;
 	uint16_t y1 = area->x1;
 	uint16_t y2 = area->x2;
-	int flag = 0;
-	if (y1 % 4 == 0 && (y2 - y1 + 1) % 4 == 0)
-	{
-		flag = 1;
-		// ESP_LOGI(TAG, "batch write bit.");
-	}
+	size_t size = lv_area_get_width(area) * lv_area_get_height(area);
 
-	uint32_t y_array_size;
-	uint32_t array_size;
-	uint8_t *data;
-	if (flag == 1)
-	{
-		set_col_page(x1, x2, y1, y2);
-		y_array_size = (y2 - y1 + 1) * 2;
-		array_size = (y2 - y1 + 1) * (x2 - x1 + 1) * 2;
-		data = (uint8_t *)malloc(array_size);
-	}
-	else
-	{
-		y_array_size = (y2 - y1 + 1) * 2;
-		data = (uint8_t *)malloc(y_array_size);
-	}
-	for (size_t xpos = x1; xpos < x2 + 1; xpos++)
-	{
-		// memset(data, 0xFF,array_size);
-		for (size_t i = 0; i < y_array_size; i += 2)
-		{
-			if (flag == 1)
-			{
-				data[(xpos - x1) * y_array_size + i] = color_map[(xpos - x1) * y_array_size + i + 1];
-				data[(xpos - x1) * y_array_size + i + 1] = color_map[(xpos - x1) * y_array_size + i];
-			}
-			else
-			{
-				data[i] = color_map[(xpos - x1) * y_array_size + i + 1];
-				data[i + 1] = color_map[(xpos - x1) * y_array_size + i];
-			}
-		}
-		if (flag == 0)
-		{
-			set_col_page(xpos, xpos, y1, y2);
-			esp_lcd_panel_io_tx_param(lcd_io_handle, -1, data, y_array_size);
-		}
-	}
-	if (flag == 1)
+	if ((y1 % 4 != 0 || (y2 - y1 + 1) % 4 != 0) && !unaligned_logged)
 	{
-		esp_lcd_panel_io_tx_param(lcd_io_handle, -1, data, array_size);
+		ESP_LOGE(TAG, "Unaligned area, set disp_driver_rounder as the rounder_cb");
+		unaligned_logged = true;
 	}
-	// 必要，否则内存溢出报错
-	free(data);
+
+	set_col_page(x1, x2, y1, y2);
+
+#if LV_COLOR_16_SWAP == 0
+	// Swapped in place, LVGL renders the buffer again before the next flush
+	disp_pixconv_from_lv(color_map, color_map, size);
+#endif
+	esp_lcd_panel_io_tx_param(lcd_io_handle, -1, color_map, size * 2);
 	lv_disp_flush_ready(drv);
 }
\ No newline at end of file
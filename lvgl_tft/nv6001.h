@@ -46,6 +46,9 @@ extern "C"
     void display_color(uint16_t color);
     void nv6001_init();
     void nv6001_flush(lv_disp_drv_t *drv, const lv_area_t *area, uint8_t *color_map);
+    // Widens areas to the 4 pixel alignment the flush needs, to be called
+    // from the rounder_cb (disp_driver_rounder)
+    void nv6001_rounder(lv_disp_drv_t *drv, lv_area_t *area);
 
 #ifdef __cplusplus
 } /* extern "C" */
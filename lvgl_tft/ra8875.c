@@ -21,8 +21,6 @@
 
 #define DIV_ROUND_UP(n, d) (((n)+(d)-1)/(d))
 
-#define SPI_CLOCK_SPEED_SLOW_HZ 1000000
-
 #define RA8875_MODE_DATA_WRITE  (0x00)
 #define RA8875_MODE_DATA_READ   (0x40)
 #define RA8875_MODE_CMD_WRITE   (0x80)
@@ -37,6 +35,8 @@
 #endif
 #define BYTES_PER_PIXEL (LV_COLOR_DEPTH / 8)
 
+#define WRITE_CMDS_BATCH_MAX 20
+
 #define HDWR_VAL (LV_HOR_RES_MAX/8 - 1)
 #define VDHR_VAL (LV_VER_RES_MAX - 1)
 
@@ -96,6 +96,10 @@
 /**********************
  *      TYPEDEFS
  **********************/
+typedef struct {
+    uint8_t cmd;                                       // Register address of command
+    uint8_t data;                                      // Value to write to register
+} ra8875_reg_write_t;
 
 /**********************
  *  STATIC PROTOTYPES
@@ -104,6 +108,7 @@ static void ra8875_configure_clocks(bool high_speed);
 static void ra8875_set_memory_write_cursor(unsigned int x, unsigned int y);
 static void ra8875_set_window(unsigned int xs, unsigned int xe, unsigned int ys, unsigned int ye);
 static void ra8875_send_buffer(uint8_t * data, size_t length, bool signal_flush);
+static void ra8875_write_cmds(const ra8875_reg_write_t * regs, size_t count, disp_spi_send_flag_t flags);
 
 /**********************
  *  STATIC VARIABLES
@@ -121,10 +126,7 @@ void ra8875_init(void)
 {
     unsigned int i = 0;
 
-    struct {
-        uint8_t cmd;                                   // Register address of command
-        uint8_t data;                                  // Value to write to register
-    } init_cmds[] = {
+    const ra8875_reg_write_t init_cmds[] = {
         {RA8875_REG_SYSR,   SYSR_VAL},                 // System Configuration Register (SYSR)
         {RA8875_REG_HDWR,   HDWR_VAL},                 // LCD Horizontal Display Width Register (HDWR)
         {RA8875_REG_HNDFTR, HNDFTR_VAL},               // Horizontal Non-Display Period Fine Tuning Option Register (HNDFTR)
@@ -173,14 +175,12 @@ void ra8875_init(void)
     vTaskDelay(DIV_ROUND_UP(100, portTICK_RATE_MS));
 
     // Initalize RA8875 clocks (SPI must be decelerated before initializing clocks)
-    disp_spi_change_device_speed(SPI_CLOCK_SPEED_SLOW_HZ);
+    disp_spi_use_slow_clock(true);
     ra8875_configure_clocks(true);
-    disp_spi_change_device_speed(-1);
+    disp_spi_use_slow_clock(false);
 
     // Send all the commands
-    for (i = 0; i < INIT_CMDS_SIZE; i++) {
-        ra8875_write_cmd(init_cmds[i].cmd, init_cmds[i].data);
-    }
+    ra8875_write_cmds(init_cmds, INIT_CMDS_SIZE, DISP_SPI_SEND_SYNCHRONOUS);
 
     // Perform a memory clear (wait maximum of 100 ticks)
     ra8875_write_cmd(RA8875_REG_MCLR, 0x80);
@@ -277,7 +277,7 @@ void ra8875_flush(lv_disp_drv_t * drv, const lv_area_t * area, lv_color_t * colo
 
 void ra8875_sleep_in(void)
 {
-    disp_spi_change_device_speed(SPI_CLOCK_SPEED_SLOW_HZ);
+    disp_spi_use_slow_clock(true);
 
     ra8875_configure_clocks(false);
 
@@ -293,7 +293,7 @@ void ra8875_sleep_out(void)
 
     ra8875_configure_clocks(true);
 
-    disp_spi_change_device_speed(-1);
+    disp_spi_use_slow_clock(false);
 
     ra8875_write_cmd(RA8875_REG_PWRR, 0x80);           // Power and Display Control Register (PWRR)
     vTaskDelay(DIV_ROUND_UP(20, portTICK_RATE_MS));
@@ -302,7 +302,7 @@ void ra8875_sleep_out(void)
 uint8_t ra8875_read_cmd(uint8_t cmd)
 {
     uint8_t buf[4] = {RA8875_MODE_CMD_WRITE, cmd, RA8875_MODE_DATA_READ, 0x00};
-    disp_spi_transaction(buf, sizeof(buf), (disp_spi_send_flag_t)(DISP_SPI_RECEIVE | DISP_SPI_SEND_POLLING), buf, 0, 0);
+    disp_spi_transaction(buf, sizeof(buf), (disp_spi_send_flag_t)(DISP_SPI_RECEIVE | DISP_SPI_SEND_POLLING | DISP_SPI_CLOCK_SLOW), buf, 0, 0);
     return buf[3];
 }
 
@@ -334,22 +334,30 @@ void ra8875_configure_clocks(bool high_speed)
 
 static void ra8875_set_window(unsigned int xs, unsigned int xe, unsigned int ys, unsigned int ye)
 {
-    ra8875_write_cmd(RA8875_REG_HSAW0, (uint8_t)(xs & 0x0FF)); // Horizontal Start Point 0 of Active Window (HSAW0)
-    ra8875_write_cmd(RA8875_REG_HSAW1, (uint8_t)(xs >> 8));    // Horizontal Start Point 1 of Active Window (HSAW1)
-    ra8875_write_cmd(RA8875_REG_VSAW0, (uint8_t)(ys & 0x0FF)); // Vertical Start Point 0 of Active Window (VSAW0)
-    ra8875_write_cmd(RA8875_REG_VSAW1, (uint8_t)(ys >> 8));    // Vertical Start Point 1 of Active Window (VSAW1)
-    ra8875_write_cmd(RA8875_REG_HEAW0, (uint8_t)(xe & 0x0FF)); // Horizontal End Point 0 of Active Window (HEAW0)
-    ra8875_write_cmd(RA8875_REG_HEAW1, (uint8_t)(xe >> 8));    // Horizontal End Point 1 of Active Window (HEAW1)
-    ra8875_write_cmd(RA8875_REG_VEAW0, (uint8_t)(ye & 0x0FF)); // Vertical End Point of Active Window 0 (VEAW0)
-    ra8875_write_cmd(RA8875_REG_VEAW1, (uint8_t)(ye >> 8));    // Vertical End Point of Active Window 1 (VEAW1)
+    const ra8875_reg_write_t regs[] = {
+        {RA8875_REG_HSAW0, (uint8_t)(xs & 0x0FF)},     // Horizontal Start Point 0 of Active Window (HSAW0)
+        {RA8875_REG_HSAW1, (uint8_t)(xs >> 8)},        // Horizontal Start Point 1 of Active Window (HSAW1)
+        {RA8875_REG_VSAW0, (uint8_t)(ys & 0x0FF)},     // Vertical Start Point 0 of Active Window (VSAW0)
+        {RA8875_REG_VSAW1, (uint8_t)(ys >> 8)},        // Vertical Start Point 1 of Active Window (VSAW1)
+        {RA8875_REG_HEAW0, (uint8_t)(xe & 0x0FF)},     // Horizontal End Point 0 of Active Window (HEAW0)
+        {RA8875_REG_HEAW1, (uint8_t)(xe >> 8)},        // Horizontal End Point 1 of Active Window (HEAW1)
+        {RA8875_REG_VEAW0, (uint8_t)(ye & 0x0FF)},     // Vertical End Point of Active Window 0 (VEAW0)
+        {RA8875_REG_VEAW1, (uint8_t)(ye >> 8)},        // Vertical End Point of Active Window 1 (VEAW1)
+    };
+
+    ra8875_write_cmds(regs, sizeof(regs)/sizeof(regs[0]), DISP_SPI_SEND_QUEUED);
 }
 
 static void ra8875_set_memory_write_cursor(unsigned int x, unsigned int y)
 {
-    ra8875_write_cmd(RA8875_REG_CURH0, (uint8_t)(x & 0x0FF));  // Memory Write Cursor Horizontal Position Register 0 (CURH0)
-    ra8875_write_cmd(RA8875_REG_CURH1, (uint8_t)(x >> 8));     // Memory Write Cursor Horizontal Position Register 1 (CURH1)
-    ra8875_write_cmd(RA8875_REG_CURV0, (uint8_t)(y & 0x0FF));  // Memory Write Cursor Vertical Position Register 0 (CURV0)
-    ra8875_write_cmd(RA8875_REG_CURV1, (uint8_t)(y >> 8));     // Memory Write Cursor Vertical Position Register 1 (CURV1)
+    const ra8875_reg_write_t regs[] = {
+        {RA8875_REG_CURH0, (uint8_t)(x & 0x0FF)},      // Memory Write Cursor Horizontal Position Register 0 (CURH0)
+        {RA8875_REG_CURH1, (uint8_t)(x >> 8)},         // Memory Write Cursor Horizontal Position Register 1 (CURH1)
+        {RA8875_REG_CURV0, (uint8_t)(y & 0x0FF)},      // Memory Write Cursor Vertical Position Register 0 (CURV0)
+        {RA8875_REG_CURV1, (uint8_t)(y >> 8)},         // Memory Write Cursor Vertical Position Register 1 (CURV1)
+    };
+
+    ra8875_write_cmds(regs, sizeof(regs)/sizeof(regs[0]), DISP_SPI_SEND_QUEUED);
 }
 
 static void ra8875_send_buffer(uint8_t * data, size_t length, bool signal_flush)
@@ -361,5 +369,34 @@ static void ra8875_send_buffer(uint8_t * data, size_t length, bool signal_flush)
     const uint64_t prefix = (RA8875_MODE_CMD_WRITE << 16)      // Command write mode
                           | (RA8875_REG_MRWC << 8)             // Memory Read/Write Command (MRWC)
                           | (RA8875_MODE_DATA_WRITE);          // Data write mode
-    disp_spi_transaction(data, length, flags, NULL, prefix, 0);
+    disp_spi_transaction_stream(data, length, flags, prefix);
+}
+
+/* Register writes are independent 4 bytes transactions, queue them as a batch */
+static void ra8875_write_cmds(const ra8875_reg_write_t * regs, size_t count, disp_spi_send_flag_t flags)
+{
+    uint8_t bufs[WRITE_CMDS_BATCH_MAX][4];
+    disp_spi_segment_t segs[WRITE_CMDS_BATCH_MAX];
+
+    while (count > 0) {
+        size_t n = (count < WRITE_CMDS_BATCH_MAX) ? count : WRITE_CMDS_BATCH_MAX;
+
+        for (size_t i = 0; i < n; i++) {
+            bufs[i][0] = RA8875_MODE_CMD_WRITE;
+            bufs[i][1] = regs[i].cmd;
+            bufs[i][2] = RA8875_MODE_DATA_WRITE;
+            bufs[i][3] = regs[i].data;
+
+            segs[i].data = bufs[i];
+            segs[i].length = sizeof(bufs[i]);
+            segs[i].flags = DISP_SPI_SEND_QUEUED;
+            segs[i].addr = 0;
+        }
+
+        /* 4 bytes segments are copied when queued, bufs can be reused right away */
+        disp_spi_transaction_batch(segs, n, flags);
+
+        regs += n;
+        count -= n;
+    }
 }
@@ -8,6 +8,7 @@
  *********************/
 #include "sh1107.h"
 #include "disp_spi.h"
+#include "disp_pixconv.h"
 #include "driver/gpio.h"
 #include "esp_log.h"
 #include "freertos/FreeRTOS.h"
@@ -18,6 +19,17 @@
  *********************/
  #define TAG "SH1107"
 
+/* Pages of 8 pixels across the panel */
+#if defined CONFIG_LV_DISPLAY_ORIENTATION_LANDSCAPE
+#define SH1107_PAGES    (LV_HOR_RES_MAX / 8)
+#else
+#define SH1107_PAGES    (LV_VER_RES_MAX / 8)
+#endif
+
+#if defined CONFIG_LV_DISP_MONO_PAGE_PACK && (LV_COLOR_DEPTH != 1)
+    #error "CONFIG_LV_DISP_MONO_PAGE_PACK needs LV_COLOR_DEPTH 1"
+#endif
+
 /**********************
  *      TYPEDEFS
  **********************/
@@ -33,20 +45,20 @@ typedef struct {
  *  STATIC PROTOTYPES
  **********************/
 static void sh1107_send_cmd(uint8_t cmd);
-static void sh1107_send_data(void * data, uint16_t length);
-static void sh1107_send_color(void * data, uint16_t length);
+static void sh1107_send_data(void * data, size_t length);
 
 /**********************
  *  STATIC VARIABLES
  **********************/
+#if defined CONFIG_LV_DISP_MONO_PAGE_PACK
+/* The flushed area packed into pages, read by the DMA */
+WORD_ALIGNED_ATTR static uint8_t page_buf[LV_HOR_RES_MAX * LV_VER_RES_MAX / 8];
+#endif
 
 /**********************
  *      MACROS
  **********************/
 
-#define BIT_SET(a,b) ((a) |= (1U<<(b)))
-#define BIT_CLEAR(a,b) ((a) &= ~(1U<<(b)))
-
 /**********************
  *   GLOBAL FUNCTIONS
  **********************/
@@ -109,6 +121,7 @@ void sh1107_init(void)
 	    sh1107_send_cmd(init_cmds[cmd].cmd);
 	    sh1107_send_data(init_cmds[cmd].data, init_cmds[cmd].databytes&0x1F);
 	    if (init_cmds[cmd].databytes & 0x80) {
+		disp_wait_for_pending_transactions();
 		vTaskDelay(100 / portTICK_RATE_MS);
 	    }
 	    cmd++;
@@ -120,65 +133,86 @@ void sh1107_set_px_cb(struct _disp_drv_t * disp_drv, uint8_t * buf, lv_coord_t b
 {
 	/* buf_w will be ignored, the configured CONFIG_LV_DISPLAY_HEIGHT and _WIDTH,
 	   and CONFIG_LV_DISPLAY_ORIENTATION_LANDSCAPE and _PORTRAIT will be used. */
-    uint16_t byte_index = 0;
-    uint8_t  bit_index = 0;
+    bool on = (color.full == 0) && (LV_OPA_TRANSP != opa);
 
 #if defined CONFIG_LV_DISPLAY_ORIENTATION_LANDSCAPE
-	byte_index = y + (( x>>3 ) * LV_VER_RES_MAX);
-	bit_index  = x & 0x7;
+	disp_pixconv_mono_page_set(buf, LV_VER_RES_MAX, y, x, on);
 #elif defined CONFIG_LV_DISPLAY_ORIENTATION_PORTRAIT
-    byte_index = x + (( y>>3 ) * LV_HOR_RES_MAX);
-    bit_index  = y & 0x7;
+    disp_pixconv_mono_page_set(buf, LV_HOR_RES_MAX, x, y, on);
 #endif
-
-    if ((color.full == 0) && (LV_OPA_TRANSP != opa)) {
-        BIT_SET(buf[byte_index], bit_index);
-    } else {
-        BIT_CLEAR(buf[byte_index], bit_index);
-    }
 }
 
 void sh1107_flush(lv_disp_drv_t * drv, const lv_area_t * area, lv_color_t * color_map)
 {
-    uint8_t columnLow = area->x1 & 0x0F;
-	uint8_t columnHigh = (area->x1 >> 4) & 0x0F;
-    uint8_t row1 = 0, row2 = 0;
-    uint32_t size = 0;
-    void *ptr;
-
+    disp_spi_segment_t segs[2 * SH1107_PAGES];
+    uint8_t cmds[SH1107_PAGES][3];
+    size_t count = 0;
+    uint8_t *pages = (uint8_t *) color_map;
+
+    /* The pages run along x when the panel is mounted sideways, the columns
+       along y then. The set_px callback lays them out a full display line
+       apart, the packers back to back. */
 #if defined CONFIG_LV_DISPLAY_ORIENTATION_LANDSCAPE
-    row1 = area->x1>>3;
-    row2 = area->x2>>3;
+    uint8_t row1 = area->x1 >> 3;
+    uint8_t row2 = area->x2 >> 3;
+    uint16_t column = area->y1;
+    size_t size = lv_area_get_height(area);
+#if defined CONFIG_LV_DISP_MONO_PAGE_PACK
+    size_t stride = size;
 #else
-    row1 = area->y1>>3;
-    row2 = area->y2>>3;
+    size_t stride = LV_VER_RES_MAX;
+#endif
+#else
+    uint8_t row1 = area->y1 >> 3;
+    uint8_t row2 = area->y2 >> 3;
+    uint16_t column = area->x1;
+    size_t size = lv_area_get_width(area);
+#if defined CONFIG_LV_DISP_MONO_PAGE_PACK
+    size_t stride = size;
+#else
+    size_t stride = LV_HOR_RES_MAX;
+#endif
 #endif
-    for(int i = row1; i < row2+1; i++){
-	    sh1107_send_cmd(0x10 | columnHigh);         // Set Higher Column Start Address for Page Addressing Mode
-	    sh1107_send_cmd(0x00 | columnLow);          // Set Lower Column Start Address for Page Addressing Mode
-	    sh1107_send_cmd(0xB0 | i);                  // Set Page Start Address for Page Addressing Mode
-	    size = area->y2 - area->y1 + 1;
+
+#if defined CONFIG_LV_DISP_MONO_PAGE_PACK
 #if defined CONFIG_LV_DISPLAY_ORIENTATION_LANDSCAPE
-        ptr = color_map + i * LV_VER_RES_MAX;
+    disp_pixconv_mono_cols_inv(page_buf, (const uint8_t *) color_map,
+        lv_area_get_width(area), lv_area_get_height(area));
 #else
-        ptr = color_map + i * LV_HOR_RES_MAX;
+    disp_pixconv_mono_page_inv(page_buf, (const uint8_t *) color_map,
+        lv_area_get_width(area), lv_area_get_height(area));
 #endif
-        if(i != row2){
-	    sh1107_send_data( (void *) ptr, size);
-	} else {
-	    // complete sending data by sh1107_send_color() and thus call lv_flush_ready()
-	    sh1107_send_color( (void *) ptr, size);
-	}
+    pages = page_buf;
+#endif
+
+    /* The page commands are copied by disp_spi, the pixels are read from
+       the buffer by the DMA and the last page signals the flush as done */
+    for (uint8_t page = row1; page <= row2; page++, pages += stride) {
+        uint8_t *cmd = cmds[page - row1];
+
+        cmd[0] = 0x10 | ((column >> 4) & 0x0F);    // Set Higher Column Start Address for Page Addressing Mode
+        cmd[1] = 0x00 | (column & 0x0F);           // Set Lower Column Start Address for Page Addressing Mode
+        cmd[2] = 0xB0 | page;                      // Set Page Start Address for Page Addressing Mode
+
+        segs[count++] = (disp_spi_segment_t) {cmd, 3, DISP_SPI_DC_CMD, 0};
+        segs[count++] = (disp_spi_segment_t) {pages, size, DISP_SPI_DC_DATA, 0};
     }
+
+    disp_spi_transaction_batch(segs, count, DISP_SPI_SEND_QUEUED | DISP_SPI_SIGNAL_FLUSH);
 }
 
 void sh1107_rounder(struct _disp_drv_t * disp_drv, lv_area_t *area)
 {
-    // workaround: always send complete size display buffer
-    area->x1 = 0;
-    area->y1 = 0;
-    area->x2 = LV_HOR_RES_MAX-1;
-    area->y2 = LV_VER_RES_MAX-1;
+    (void) disp_drv;
+
+    /* Whole pages, the columns are left to LVGL */
+#if defined CONFIG_LV_DISPLAY_ORIENTATION_LANDSCAPE
+    area->x1 &= ~0x7;
+    area->x2 |= 0x7;
+#else
+    area->y1 &= ~0x7;
+    area->y2 |= 0x7;
+#endif
 }
 
 void sh1107_sleep_in()
@@ -198,21 +232,10 @@ void sh1107_sleep_out()
 
 static void sh1107_send_cmd(uint8_t cmd)
 {
-    disp_wait_for_pending_transactions();
-    gpio_set_level(SH1107_DC, 0);	 /*Command mode*/
-    disp_spi_send_data(&cmd, 1);
-}
-
-static void sh1107_send_data(void * data, uint16_t length)
-{
-    disp_wait_for_pending_transactions();
-    gpio_set_level(SH1107_DC, 1);	 /*Data mode*/
-    disp_spi_send_data(data, length);
+    disp_spi_send_cmd(cmd);
 }
 
-static void sh1107_send_color(void * data, uint16_t length)
+static void sh1107_send_data(void * data, size_t length)
 {
-    disp_wait_for_pending_transactions();
-    gpio_set_level(SH1107_DC, 1);   /*Data mode*/
-    disp_spi_send_colors(data, length);
+    disp_spi_send_params(data, length);
 }
@@ -13,12 +13,21 @@
 /*********************
  *      INCLUDES
  *********************/
-#include "driver/i2c.h"
 #include "assert.h"
-
-#include "lvgl_i2c_conf.h"
+#include <string.h>
 
 #include "ssd1306.h"
+#include "disp_pixconv.h"
+
+#if defined CONFIG_LV_TFT_DISPLAY_PROTOCOL_SPI
+#include "disp_spi.h"
+#include "driver/gpio.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#else
+#include "lvgl_i2c.h"
+#include "lvgl_i2c_conf.h"
+#endif
 
 /*********************
  *      DEFINES
@@ -72,27 +81,46 @@
 
 #define OLED_IIC_FREQ_HZ                    400000  // I2C colock frequency
 
+#if defined CONFIG_LV_DISP_MONO_PAGE_PACK && (LV_COLOR_DEPTH != 1)
+    #error "CONFIG_LV_DISP_MONO_PAGE_PACK needs LV_COLOR_DEPTH 1"
+#endif
+
 /**********************
  *      TYPEDEFS
  **********************/
 
+/* Changed columns of a page */
+typedef struct {
+    uint8_t page;
+    uint8_t column;
+    uint8_t *data;
+    size_t len;
+} page_span_t;
+
 /**********************
  *  STATIC PROTOTYPES
  **********************/
-static uint8_t send_data(lv_disp_drv_t *disp_drv, void *bytes, size_t bytes_len);
-static uint8_t send_pixels(lv_disp_drv_t *disp_drv, void *color_buffer, size_t buffer_len);
+static void send_cmds(const uint8_t *cmds, size_t len);
+static void send_spans(lv_disp_drv_t *disp_drv, const page_span_t *spans, size_t count);
 
 /**********************
  *  STATIC VARIABLES
  **********************/
+#if defined CONFIG_LV_DISP_MONO_PAGE_PACK
+/* The flushed area packed into pages */
+static uint8_t page_buf[OLED_COLUMNS * OLED_PAGES];
+#endif
+
+/* Copy of the panel GDDRAM, only the bytes that differ from it are sent.
+   A page is unknown until one flush covered it across the whole width,
+   bit n of page_valid is set from then on for page n. */
+static uint8_t gddram[OLED_COLUMNS * OLED_PAGES];
+static uint8_t page_valid;
 
 /**********************
  *      MACROS
  **********************/
 
-#define BIT_SET(a,b) ((a) |= (1U<<(b)))
-#define BIT_CLEAR(a,b) ((a) &= ~(1U<<(b)))
-
 /**********************
  *   GLOBAL FUNCTIONS
  **********************/
@@ -119,10 +147,23 @@ void ssd1306_init(void)
     display_mode = OLED_CMD_DISPLAY_NORMAL;
 #endif
 
+#if defined CONFIG_LV_TFT_DISPLAY_PROTOCOL_SPI
+    gpio_pad_select_gpio(SSD1306_DC);
+    gpio_set_direction(SSD1306_DC, GPIO_MODE_OUTPUT);
+    gpio_pad_select_gpio(SSD1306_RST);
+    gpio_set_direction(SSD1306_RST, GPIO_MODE_OUTPUT);
+
+    gpio_set_level(SSD1306_RST, 0);
+    vTaskDelay(10 / portTICK_PERIOD_MS);
+    gpio_set_level(SSD1306_RST, 1);
+    vTaskDelay(10 / portTICK_PERIOD_MS);
+#endif
+
     uint8_t conf[] = {
-        OLED_CONTROL_BYTE_CMD_STREAM,
         OLED_CMD_SET_CHARGE_PUMP,
         0x14,
+        OLED_CMD_SET_MEMORY_ADDR_MODE,
+        0x00,
         orientation_1,
         orientation_2,
         OLED_CMD_SET_CONTRAST,
@@ -131,21 +172,15 @@ void ssd1306_init(void)
         OLED_CMD_DISPLAY_ON
     };
 
-    uint8_t err = send_data(NULL, conf, sizeof(conf));
-    assert(0 == err);
+    send_cmds(conf, sizeof(conf));
+
+    page_valid = 0;
 }
 
 void ssd1306_set_px_cb(lv_disp_drv_t * disp_drv, uint8_t * buf, lv_coord_t buf_w, lv_coord_t x, lv_coord_t y,
         lv_color_t color, lv_opa_t opa)
 {
-    uint16_t byte_index = x + (( y>>3 ) * buf_w);
-    uint8_t  bit_index  = y & 0x7;
-
-    if ((color.full == 0) && (LV_OPA_TRANSP != opa)) {
-        BIT_SET(buf[byte_index], bit_index);
-    } else {
-        BIT_CLEAR(buf[byte_index], bit_index);
-    }
+    disp_pixconv_mono_page_set(buf, buf_w, x, y, (color.full == 0) && (LV_OPA_TRANSP != opa));
 }
 
 void ssd1306_flush(lv_disp_drv_t * disp_drv, const lv_area_t * area, lv_color_t * color_p)
@@ -153,104 +188,144 @@ void ssd1306_flush(lv_disp_drv_t * disp_drv, const lv_area_t * area, lv_color_t
     /* Divide by 8 */
     uint8_t row1 = area->y1 >> 3;
     uint8_t row2 = area->y2 >> 3;
+    lv_coord_t w = lv_area_get_width(area);
+    uint8_t *pages = (uint8_t *) color_p;
+    page_span_t spans[OLED_PAGES];
+    size_t count = 0;
+    bool full_width = (area->x1 == 0) && (area->x2 >= disp_drv->hor_res - 1);
+
+#if defined CONFIG_LV_DISP_MONO_PAGE_PACK
+    disp_pixconv_mono_page_inv(page_buf, (const uint8_t *) color_p, w, lv_area_get_height(area));
+    pages = page_buf;
+#endif
 
-    uint8_t conf[] = {
-        OLED_CONTROL_BYTE_CMD_STREAM,
-        OLED_CMD_SET_MEMORY_ADDR_MODE,
-        0x00,
-        OLED_CMD_SET_COLUMN_RANGE,
-        (uint8_t) area->x1,
-        (uint8_t) area->x2,
-        OLED_CMD_SET_PAGE_RANGE,
-        row1,
-        row2,
-    };
-
-    uint8_t err = send_data(disp_drv, conf, sizeof(conf));
-    assert(0 == err);
-    err = send_pixels(disp_drv, color_p, OLED_COLUMNS * (1 + row2 - row1));
-    assert(0 == err);
+    /* Only the changed span of each page goes over the bus */
+    for (uint8_t page = row1; page <= row2; page++, pages += w) {
+        uint8_t *shadow = &gddram[page * OLED_COLUMNS + area->x1];
+        lv_coord_t first = 0;
+        lv_coord_t last = w - 1;
+
+        if (page_valid & (1 << page)) {
+            while (first < w && pages[first] == shadow[first]) {
+                first++;
+            }
+            if (first == w) {
+                continue;
+            }
+            while (pages[last] == shadow[last]) {
+                last--;
+            }
+        }
+
+        memcpy(&shadow[first], &pages[first], last - first + 1);
+        spans[count++] = (page_span_t) {page, area->x1 + first, &pages[first], last - first + 1};
+
+        if (full_width) {
+            page_valid |= 1 << page;
+        }
+    }
 
-    lv_disp_flush_ready(disp_drv);
+    send_spans(disp_drv, spans, count);
 }
 
 void ssd1306_rounder(lv_disp_drv_t * disp_drv, lv_area_t *area)
 {
-    uint8_t hor_max = disp_drv->hor_res;
-    uint8_t ver_max = disp_drv->ver_res;
+    (void) disp_drv;
 
-    area->x1 = 0;
-    area->y1 = 0;
-    area->x2 = hor_max - 1;
-    area->y2 = ver_max - 1;
+    /* Whole pages, the columns are left to LVGL */
+    area->y1 &= ~0x7;
+    area->y2 |= 0x7;
 }
 
 void ssd1306_sleep_in(void)
 {
     uint8_t conf[] = {
-        OLED_CONTROL_BYTE_CMD_STREAM,
         OLED_CMD_DISPLAY_OFF
     };
 
-    uint8_t err = send_data(NULL, conf, sizeof(conf));
-    assert(0 == err);
+    send_cmds(conf, sizeof(conf));
 }
 
 void ssd1306_sleep_out(void)
 {
     uint8_t conf[] = {
-        OLED_CONTROL_BYTE_CMD_STREAM,
         OLED_CMD_DISPLAY_ON
     };
 
-    uint8_t err = send_data(NULL, conf, sizeof(conf));
-    assert(0 == err);
+    send_cmds(conf, sizeof(conf));
 }
 
 /**********************
  *   STATIC FUNCTIONS
  **********************/
-static uint8_t send_data(lv_disp_drv_t *disp_drv, void *bytes, size_t bytes_len)
-{
-    (void) disp_drv;
-    esp_err_t err;
 
-    uint8_t *data = (uint8_t *) bytes;
+/* Both transports take the same commands and page data, the I2C one adds
+   the control byte selecting commands or data, the SPI one sets the DC line */
+#if defined CONFIG_LV_TFT_DISPLAY_PROTOCOL_SPI
 
-    i2c_cmd_handle_t cmd = i2c_cmd_link_create();
+static void send_cmds(const uint8_t *cmds, size_t len)
+{
+    disp_spi_transaction(cmds, len, DISP_SPI_SEND_QUEUED | DISP_SPI_DC_CMD, NULL, 0, 0);
+}
 
-    i2c_master_start(cmd);
-    i2c_master_write_byte(cmd, (OLED_I2C_ADDRESS << 1) | I2C_MASTER_WRITE, true);
+static void send_spans(lv_disp_drv_t *disp_drv, const page_span_t *spans, size_t count)
+{
+    disp_spi_segment_t segs[2 * OLED_PAGES];
+    uint8_t cmds[OLED_PAGES][6];
 
-    for (size_t idx = 0; idx < bytes_len; idx++) {
-        i2c_master_write_byte(cmd, data[idx], true);
+    if (count == 0) {
+        lv_disp_flush_ready(disp_drv);
+        return;
     }
 
-    i2c_master_stop(cmd);
+    /* the commands are copied by disp_spi, the page data is read from the
+       draw buffer and the last span signals the flush as done */
+    for (size_t i = 0; i < count; i++) {
+        uint8_t *cmd = cmds[i];
 
-    /* Send queued commands */
-    err = i2c_master_cmd_begin(DISP_I2C_PORT, cmd, 10 / portTICK_PERIOD_MS);
-    i2c_cmd_link_delete(cmd);
+        cmd[0] = OLED_CMD_SET_COLUMN_RANGE;
+        cmd[1] = spans[i].column;
+        cmd[2] = (uint8_t) (spans[i].column + spans[i].len - 1);
+        cmd[3] = OLED_CMD_SET_PAGE_RANGE;
+        cmd[4] = spans[i].page;
+        cmd[5] = spans[i].page;
 
-    return ESP_OK == err ? 0 : 1;
-}
+        segs[2 * i] = (disp_spi_segment_t) {cmd, 6, DISP_SPI_DC_CMD, 0};
+        segs[2 * i + 1] = (disp_spi_segment_t) {spans[i].data, spans[i].len, DISP_SPI_DC_DATA, 0};
+    }
 
-static uint8_t send_pixels(lv_disp_drv_t *disp_drv, void *color_buffer, size_t buffer_len)
-{
-    (void) disp_drv;
-    esp_err_t err;
+    disp_spi_transaction_batch(segs, 2 * count, DISP_SPI_SEND_QUEUED | DISP_SPI_SIGNAL_FLUSH);
+}
 
-    i2c_cmd_handle_t cmd = i2c_cmd_link_create();
-    i2c_master_start(cmd);
-    i2c_master_write_byte(cmd, (OLED_I2C_ADDRESS << 1) | I2C_MASTER_WRITE, true);
+#else
 
-    i2c_master_write_byte(cmd, OLED_CONTROL_BYTE_DATA_STREAM, true);
-    i2c_master_write(cmd, (uint8_t *) color_buffer, buffer_len, true);
-    i2c_master_stop(cmd);
+static void send_cmds(const uint8_t *cmds, size_t len)
+{
+    esp_err_t err = lvgl_i2c_write(DISP_I2C_PORT, OLED_I2C_ADDRESS,
+        OLED_CONTROL_BYTE_CMD_STREAM, cmds, len);
+    assert(ESP_OK == err);
+}
 
-    /* Send queued commands */
-    err = i2c_master_cmd_begin(DISP_I2C_PORT, cmd, 10 / portTICK_PERIOD_MS);
-    i2c_cmd_link_delete(cmd);
+static void send_spans(lv_disp_drv_t *disp_drv, const page_span_t *spans, size_t count)
+{
+    for (size_t i = 0; i < count; i++) {
+        uint8_t conf[] = {
+            OLED_CMD_SET_COLUMN_RANGE,
+            spans[i].column,
+            (uint8_t) (spans[i].column + spans[i].len - 1),
+            OLED_CMD_SET_PAGE_RANGE,
+            spans[i].page,
+            spans[i].page,
+        };
+
+        send_cmds(conf, sizeof(conf));
+
+        esp_err_t err = lvgl_i2c_write(DISP_I2C_PORT, OLED_I2C_ADDRESS,
+            OLED_CONTROL_BYTE_DATA_STREAM, spans[i].data, spans[i].len);
+        assert(ESP_OK == err);
+    }
 
-    return ESP_OK == err ? 0 : 1;
+    lv_disp_flush_ready(disp_drv);
 }
+
+#endif
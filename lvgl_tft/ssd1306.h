@@ -25,8 +25,13 @@ extern "C" {
 /*********************
  *      DEFINES
  *********************/
+#if defined CONFIG_LV_TFT_DISPLAY_PROTOCOL_SPI
+#define SSD1306_DC      CONFIG_LV_DISP_PIN_DC
+#define SSD1306_RST     CONFIG_LV_DISP_PIN_RST
+#else
 #define SSD1306_SDA     CONFIG_LV_DISP_PIN_SDA
 #define SSD1306_SCL     CONFIG_LV_DISP_PIN_SCL
+#endif
 #define SSD1306_DISPLAY_ORIENTATION     TFT_ORIENTATION_LANDSCAPE
 
 /**********************
@@ -8,6 +8,7 @@
  *********************/
 #include "st7735s.h"
 #include "disp_spi.h"
+#include "lvgl_i2c.h"
 #include "driver/i2c.h"
 #include "driver/gpio.h"
 #include "esp_log.h"
@@ -35,8 +36,8 @@ typedef struct {
  *  STATIC PROTOTYPES
  **********************/
 static void st7735s_send_cmd(uint8_t cmd);
-static void st7735s_send_data(void * data, uint16_t length);
-static void st7735s_send_color(void * data, uint16_t length);
+static void st7735s_send_data(void * data, size_t length);
+static void st7735s_send_color(void * data, size_t length);
 static void st7735s_set_orientation(uint8_t orientation);
 static void i2c_master_init();
 static void axp192_write_byte(uint8_t addr, uint8_t data);
@@ -116,6 +117,7 @@ void st7735s_init(void)
 		st7735s_send_cmd(init_cmds[cmd].cmd);
 		st7735s_send_data(init_cmds[cmd].data, init_cmds[cmd].databytes&0x1F);
 		if (init_cmds[cmd].databytes & 0x80) {
+			disp_wait_for_pending_transactions();
 			vTaskDelay(100 / portTICK_RATE_MS);
 		}
 		cmd++;
@@ -175,23 +177,17 @@ void st7735s_sleep_out()
 
 static void st7735s_send_cmd(uint8_t cmd)
 {
-	disp_wait_for_pending_transactions();
-	gpio_set_level(ST7735S_DC, 0);	 /*Command mode*/
-	disp_spi_send_data(&cmd, 1);
+	disp_spi_send_cmd(cmd);
 }
 
-static void st7735s_send_data(void * data, uint16_t length)
+static void st7735s_send_data(void * data, size_t length)
 {
-	disp_wait_for_pending_transactions();
-	gpio_set_level(ST7735S_DC, 1);	 /*Data mode*/
-	disp_spi_send_data(data, length);
+	disp_spi_send_params(data, length);
 }
 
-static void st7735s_send_color(void * data, uint16_t length)
+static void st7735s_send_color(void * data, size_t length)
 {
-	disp_wait_for_pending_transactions();
-	gpio_set_level(ST7735S_DC, 1);   /*Data mode*/
-	disp_spi_send_colors(data, length);
+	disp_spi_send_pixels(data, length);
 }
 
 static void st7735s_set_orientation(uint8_t orientation)
@@ -231,20 +227,10 @@ static void i2c_master_init()
 
 static void axp192_write_byte(uint8_t addr, uint8_t data)
 {
-	esp_err_t ret;
-	i2c_cmd_handle_t cmd = i2c_cmd_link_create();
-
-	i2c_master_start(cmd);
-	i2c_master_write_byte(cmd, (AXP192_I2C_ADDRESS << 1) | I2C_MASTER_WRITE, true);
-	i2c_master_write_byte(cmd, addr, true);
-	i2c_master_write_byte(cmd, data, true);
-	i2c_master_stop(cmd);
-
-	ret = i2c_master_cmd_begin(I2C_NUM_0, cmd, 10/portTICK_PERIOD_MS);
+	esp_err_t ret = lvgl_i2c_write(I2C_NUM_0, AXP192_I2C_ADDRESS, addr, &data, 1);
 	if (ret != ESP_OK) {
 		ESP_LOGE(TAG, "AXP192 send failed. code: 0x%.2X", ret);
 	}
-	i2c_cmd_link_delete(cmd);
 }
 
 static void axp192_init()
@@ -13,6 +13,7 @@
 #include "st7789.h"
 
 #include "disp_spi.h"
+#include "disp_mipi.h"
 #include "driver/gpio.h"
 
 /*********************
@@ -23,25 +24,73 @@
  *      TYPEDEFS
  **********************/
 
-/*The LCD needs a bunch of command/argument values to be initialized. They are stored in this struct. */
-typedef struct {
-    uint8_t cmd;
-    uint8_t data[16];
-    uint8_t databytes; //No of data in data; bit 7 = delay after set; 0xFF = end of cmds.
-} lcd_init_cmd_t;
-
 /**********************
  *  STATIC PROTOTYPES
  **********************/
-static void st7789_set_orientation(uint8_t orientation);
-
-static void st7789_send_cmd(uint8_t cmd);
-static void st7789_send_data(void *data, uint16_t length);
-static void st7789_send_color(void *data, uint16_t length);
 
 /**********************
  *  STATIC VARIABLES
  **********************/
+static const disp_mipi_init_cmd_t st7789_init_cmds[] = {
+    {0xCF, {0x00, 0x83, 0X30}, 3},
+    {0xED, {0x64, 0x03, 0X12, 0X81}, 4},
+    {ST7789_PWCTRL2, {0x85, 0x01, 0x79}, 3},
+    {0xCB, {0x39, 0x2C, 0x00, 0x34, 0x02}, 5},
+    {0xF7, {0x20}, 1},
+    {0xEA, {0x00, 0x00}, 2},
+    {ST7789_LCMCTRL, {0x26}, 1},
+    {ST7789_IDSET, {0x11}, 1},
+    {ST7789_VCMOFSET, {0x35, 0x3E}, 2},
+    {ST7789_CABCCTRL, {0xBE}, 1},
+    {ST7789_MADCTL, {0x00}, 1}, // Set to 0x28 if your display is flipped
+    {ST7789_COLMOD, {0x55}, 1},
+
+#if ST7789_INVERT_COLORS == 1
+    {ST7789_INVON, {0}, 0}, // set inverted mode
+#else
+    {ST7789_INVOFF, {0}, 0}, // set non-inverted mode
+#endif
+
+    {ST7789_RGBCTRL, {0x00, 0x1B}, 2},
+    {0xF2, {0x08}, 1},
+    {ST7789_GAMSET, {0x01}, 1},
+    {ST7789_PVGAMCTRL, {0xD0, 0x00, 0x02, 0x07, 0x0A, 0x28, 0x32, 0x44, 0x42, 0x06, 0x0E, 0x12, 0x14, 0x17}, 14},
+    {ST7789_NVGAMCTRL, {0xD0, 0x00, 0x02, 0x07, 0x0A, 0x28, 0x31, 0x54, 0x47, 0x0E, 0x1C, 0x17, 0x1B, 0x1E}, 14},
+    {ST7789_CASET, {0x00, 0x00, 0x00, 0xEF}, 4},
+    {ST7789_RASET, {0x00, 0x00, 0x01, 0x3f}, 4},
+    {ST7789_RAMWR, {0}, 0},
+    {ST7789_GCTRL, {0x07}, 1},
+    {0xB6, {0x0A, 0x82, 0x27, 0x00}, 4},
+    {ST7789_SLPOUT, {0}, 0, 5},
+    {ST7789_DISPON, {0}, 0},
+    {0, {0}, DISP_MIPI_INIT_END},
+};
+
+/* The ST7789 display controller can drive 320*240 displays, when using a 240*240
+ * display there's a gap of 80px, we need to edit the coordinates to take into
+ * account that gap, this is not necessary in all orientations. */
+static const disp_mipi_panel_t st7789_panel = {
+    .name = TAG,
+    .init_cmds = st7789_init_cmds,
+#if CONFIG_LV_PREDEFINED_DISPLAY_TTGO
+    .madctl = {0x60, 0xA0, 0x00, 0xC0},
+#else
+    .madctl = {0xC0, 0x00, 0x60, 0xA0},
+#endif
+#if (CONFIG_LV_TFT_DISPLAY_OFFSETS)
+    .x_offset = CONFIG_LV_TFT_DISPLAY_X_OFFSET,
+    .y_offset = CONFIG_LV_TFT_DISPLAY_Y_OFFSET,
+#elif (LV_HOR_RES_MAX == 240) && (LV_VER_RES_MAX == 240)
+#if (CONFIG_LV_DISPLAY_ORIENTATION_PORTRAIT)
+    .x_offset = 80,
+#elif (CONFIG_LV_DISPLAY_ORIENTATION_LANDSCAPE_INVERTED)
+    .y_offset = 80,
+#endif
+#endif
+    .bytes_per_pixel = 2,
+    .memory_lines = 320,
+    .inversion = DISP_MIPI_INVERSION_BY_TABLE,
+};
 
 /**********************
  *      MACROS
@@ -52,41 +101,6 @@ static void st7789_send_color(void *data, uint16_t length);
  **********************/
 void st7789_init(void)
 {
-    lcd_init_cmd_t st7789_init_cmds[] = {
-        {0xCF, {0x00, 0x83, 0X30}, 3},
-        {0xED, {0x64, 0x03, 0X12, 0X81}, 4},
-        {ST7789_PWCTRL2, {0x85, 0x01, 0x79}, 3},
-        {0xCB, {0x39, 0x2C, 0x00, 0x34, 0x02}, 5},
-        {0xF7, {0x20}, 1},
-        {0xEA, {0x00, 0x00}, 2},
-        {ST7789_LCMCTRL, {0x26}, 1},
-        {ST7789_IDSET, {0x11}, 1},
-        {ST7789_VCMOFSET, {0x35, 0x3E}, 2},
-        {ST7789_CABCCTRL, {0xBE}, 1},
-        {ST7789_MADCTL, {0x00}, 1}, // Set to 0x28 if your display is flipped
-        {ST7789_COLMOD, {0x55}, 1},
-
-#if ST7789_INVERT_COLORS == 1
-		{ST7789_INVON, {0}, 0}, // set inverted mode
-#else
- 		{ST7789_INVOFF, {0}, 0}, // set non-inverted mode
-#endif
-
-        {ST7789_RGBCTRL, {0x00, 0x1B}, 2},
-        {0xF2, {0x08}, 1},
-        {ST7789_GAMSET, {0x01}, 1},
-        {ST7789_PVGAMCTRL, {0xD0, 0x00, 0x02, 0x07, 0x0A, 0x28, 0x32, 0x44, 0x42, 0x06, 0x0E, 0x12, 0x14, 0x17}, 14},
-        {ST7789_NVGAMCTRL, {0xD0, 0x00, 0x02, 0x07, 0x0A, 0x28, 0x31, 0x54, 0x47, 0x0E, 0x1C, 0x17, 0x1B, 0x1E}, 14},
-        {ST7789_CASET, {0x00, 0x00, 0x00, 0xEF}, 4},
-        {ST7789_RASET, {0x00, 0x00, 0x01, 0x3f}, 4},
-        {ST7789_RAMWR, {0}, 0},
-        {ST7789_GCTRL, {0x07}, 1},
-        {0xB6, {0x0A, 0x82, 0x27, 0x00}, 4},
-        {ST7789_SLPOUT, {0}, 0x80},
-        {ST7789_DISPON, {0}, 0x80},
-        {0, {0}, 0xff},
-    };
-
     //Initialize non-SPI GPIOs
     esp_rom_gpio_pad_select_gpio(ST7789_DC);
     gpio_set_direction(ST7789_DC, GPIO_MODE_OUTPUT);
@@ -103,30 +117,14 @@ void st7789_init(void)
 
     //Reset the display
 #if !defined(CONFIG_LV_DISP_ST7789_SOFT_RESET)
-    gpio_set_level(ST7789_RST, 0);
-    vTaskDelay(100 / portTICK_PERIOD_MS);
-    gpio_set_level(ST7789_RST, 1);
-    vTaskDelay(100 / portTICK_PERIOD_MS);
+    disp_mipi_reset(ST7789_RST);
 #else
-    st7789_send_cmd(ST7789_SWRESET);
+    disp_mipi_soft_reset();
 #endif
 
-    printf("ST7789 initialization.\n");
-
-    //Send all the commands
-    uint16_t cmd = 0;
-    while (st7789_init_cmds[cmd].databytes!=0xff) {
-        st7789_send_cmd(st7789_init_cmds[cmd].cmd);
-        st7789_send_data(st7789_init_cmds[cmd].data, st7789_init_cmds[cmd].databytes&0x1F);
-        if (st7789_init_cmds[cmd].databytes & 0x80) {
-                vTaskDelay(100 / portTICK_PERIOD_MS);
-        }
-        cmd++;
-    }
+    disp_mipi_init(&st7789_panel);
 
     st7789_enable_backlight(true);
-
-    st7789_set_orientation(CONFIG_LV_DISPLAY_ORIENTATION);
 }
 
 void st7789_enable_backlight(bool backlight)
@@ -145,105 +143,26 @@ void st7789_enable_backlight(bool backlight)
 #endif
 }
 
-/* The ST7789 display controller can drive 320*240 displays, when using a 240*240
- * display there's a gap of 80px, we need to edit the coordinates to take into
- * account that gap, this is not necessary in all orientations. */
 void st7789_flush(lv_disp_drv_t * drv, const lv_area_t * area, lv_color_t * color_map)
 {
-    ESP_LOGI(TAG, "st7789_flush");
-    uint8_t data[4] = {0};
-
-    uint16_t offsetx1 = area->x1;
-    uint16_t offsetx2 = area->x2;
-    uint16_t offsety1 = area->y1;
-    uint16_t offsety2 = area->y2;
-
-#if (CONFIG_LV_TFT_DISPLAY_OFFSETS)
-    offsetx1 += CONFIG_LV_TFT_DISPLAY_X_OFFSET;
-    offsetx2 += CONFIG_LV_TFT_DISPLAY_X_OFFSET;
-    offsety1 += CONFIG_LV_TFT_DISPLAY_Y_OFFSET;
-    offsety2 += CONFIG_LV_TFT_DISPLAY_Y_OFFSET;
-
-#elif (LV_HOR_RES_MAX == 240) && (LV_VER_RES_MAX == 240)
-#if (CONFIG_LV_DISPLAY_ORIENTATION_PORTRAIT)
-    offsetx1 += 80;
-    offsetx2 += 80;
-#elif (CONFIG_LV_DISPLAY_ORIENTATION_LANDSCAPE_INVERTED)
-    offsety1 += 80;
-    offsety2 += 80;
-#endif
-#endif
-
-    /*Column addresses*/
-    st7789_send_cmd(ST7789_CASET);
-    data[0] = (offsetx1 >> 8) & 0xFF;
-    data[1] = offsetx1 & 0xFF;
-    data[2] = (offsetx2 >> 8) & 0xFF;
-    data[3] = offsetx2 & 0xFF;
-    st7789_send_data(data, 4);
-
-    /*Page addresses*/
-    st7789_send_cmd(ST7789_RASET);
-    data[0] = (offsety1 >> 8) & 0xFF;
-    data[1] = offsety1 & 0xFF;
-    data[2] = (offsety2 >> 8) & 0xFF;
-    data[3] = offsety2 & 0xFF;
-    st7789_send_data(data, 4);
-
-    /*Memory write*/
-    st7789_send_cmd(ST7789_RAMWR);
-
-    uint32_t size = lv_area_get_width(area) * lv_area_get_height(area);
-
-    st7789_send_color((void*)color_map, size * 2);
-
+    disp_mipi_flush(drv, area, color_map);
 }
 
-/**********************
- *   STATIC FUNCTIONS
- **********************/
-static void st7789_send_cmd(uint8_t cmd)
+bool st7789_scroll_init(uint16_t top_fixed, uint16_t bottom_fixed)
 {
-    disp_wait_for_pending_transactions();
-    gpio_set_level(ST7789_DC, 0);
-    disp_spi_send_data(&cmd, 1);
+    return disp_mipi_scroll_init(top_fixed, bottom_fixed);
 }
 
-static void st7789_send_data(void * data, uint16_t length)
+void st7789_scroll(lv_coord_t dy, lv_area_t *exposed)
 {
-    disp_wait_for_pending_transactions();
-    gpio_set_level(ST7789_DC, 1);
-    disp_spi_send_data(data, length);
+    disp_mipi_scroll(dy, exposed);
 }
 
-static void st7789_send_color(void * data, uint16_t length)
+void st7789_scroll_stop(void)
 {
-    disp_wait_for_pending_transactions();
-    gpio_set_level(ST7789_DC, 1);
-    disp_spi_send_colors(data, length);
+    disp_mipi_scroll_stop();
 }
 
-static void st7789_set_orientation(uint8_t orientation)
-{
-    // ESP_ASSERT(orientation < 4);
-
-    const char *orientation_str[] = {
-        "PORTRAIT", "PORTRAIT_INVERTED", "LANDSCAPE", "LANDSCAPE_INVERTED"
-    };
-
-    ESP_LOGI(TAG, "Display orientation: %s", orientation_str[orientation]);
-
-    uint8_t data[] =
-    {
-#if CONFIG_LV_PREDEFINED_DISPLAY_TTGO
-	0x60, 0xA0, 0x00, 0xC0
-#else
-	0xC0, 0x00, 0x60, 0xA0
-#endif
-    };
-
-    ESP_LOGI(TAG, "0x36 command value: 0x%02X", data[orientation]);
-
-    st7789_send_cmd(ST7789_MADCTL);
-    st7789_send_data((void *) &data[orientation], 1);
-}
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
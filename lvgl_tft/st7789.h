@@ -113,6 +113,10 @@ extern "C"
 void st7789_init(void);
 void st7789_flush(lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t *color_map);
 void st7789_enable_backlight(bool backlight);
+/* Hardware vertical scrolling, see disp_mipi_scroll_init() */
+bool st7789_scroll_init(uint16_t top_fixed, uint16_t bottom_fixed);
+void st7789_scroll(lv_coord_t dy, lv_area_t *exposed);
+void st7789_scroll_stop(void);
 
 #ifdef __cplusplus
 } /* extern "C" */
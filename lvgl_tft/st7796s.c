@@ -8,6 +8,7 @@
  *********************/
 #include "st7796s.h"
 #include "disp_spi.h"
+#include "disp_mipi.h"
 #include "driver/gpio.h"
 #include "esp_log.h"
 #include "freertos/FreeRTOS.h"
@@ -22,26 +23,60 @@
  *      TYPEDEFS
  **********************/
 
-/*The LCD needs a bunch of command/argument values to be initialized. They are stored in this struct. */
-typedef struct
-{
-	uint8_t cmd;
-	uint8_t data[16];
-	uint8_t databytes; //No of data in data; bit 7 = delay after set; 0xFF = end of cmds.
-} lcd_init_cmd_t;
-
 /**********************
  *  STATIC PROTOTYPES
  **********************/
-static void st7796s_set_orientation(uint8_t orientation);
-
-static void st7796s_send_cmd(uint8_t cmd);
-static void st7796s_send_data(void *data, uint16_t length);
-static void st7796s_send_color(void *data, uint16_t length);
 
 /**********************
  *  STATIC VARIABLES
  **********************/
+static const disp_mipi_init_cmd_t st7796s_init_cmds[] = {
+	{0xCF, {0x00, 0x83, 0X30}, 3},
+	{0xED, {0x64, 0x03, 0X12, 0X81}, 4},
+	{0xE8, {0x85, 0x01, 0x79}, 3},
+	{0xCB, {0x39, 0x2C, 0x00, 0x34, 0x02}, 5},
+	{0xF7, {0x20}, 1},
+	{0xEA, {0x00, 0x00}, 2},
+	{0xC0, {0x26}, 1},		 /*Power control*/
+	{0xC1, {0x11}, 1},		 /*Power control */
+	{0xC5, {0x35, 0x3E}, 2}, /*VCOM control*/
+	{0xC7, {0xBE}, 1},		 /*VCOM control*/
+	{0x36, {0x28}, 1},		 /*Memory Access Control*/
+	{0x3A, {0x55}, 1},		 /*Pixel Format Set*/
+	{0xB1, {0x00, 0x1B}, 2},
+	{0xF2, {0x08}, 1},
+	{0x26, {0x01}, 1},
+	{0xE0, {0x1F, 0x1A, 0x18, 0x0A, 0x0F, 0x06, 0x45, 0X87, 0x32, 0x0A, 0x07, 0x02, 0x07, 0x05, 0x00}, 15},
+	{0XE1, {0x00, 0x25, 0x27, 0x05, 0x10, 0x09, 0x3A, 0x78, 0x4D, 0x05, 0x18, 0x0D, 0x38, 0x3A, 0x1F}, 15},
+	{0x2A, {0x00, 0x00, 0x00, 0xEF}, 4},
+	{0x2B, {0x00, 0x00, 0x01, 0x3f}, 4},
+	{0x2C, {0}, 0},
+	{0xB7, {0x07}, 1},
+	{0xB6, {0x0A, 0x82, 0x27, 0x00}, 4},
+	{0x11, {0}, 0, 5},
+	{0x29, {0}, 0},
+	{0, {0}, DISP_MIPI_INIT_END},
+};
+
+static const disp_mipi_panel_t st7796s_panel = {
+	.name = TAG,
+	.init_cmds = st7796s_init_cmds,
+#if defined CONFIG_LV_PREDEFINED_DISPLAY_M5STACK
+	.madctl = {0x68, 0x68, 0x08, 0x08},
+#elif defined(CONFIG_LV_PREDEFINED_DISPLAY_WROVER4)
+	.madctl = {0x4C, 0x88, 0x28, 0xE8},
+#elif defined(CONFIG_LV_PREDEFINED_DISPLAY_WT32_SC01)
+	.madctl = {0x48, 0x88, 0x28, 0xE8},
+#elif defined(CONFIG_LV_PREDEFINED_DISPLAY_NONE)
+	.madctl = {0x48, 0x88, 0x28, 0xE8},
+#endif
+	.bytes_per_pixel = 2,
+#if ST7796S_INVERT_COLORS == 1
+	.inversion = DISP_MIPI_INVERSION_ON,
+#else
+	.inversion = DISP_MIPI_INVERSION_OFF,
+#endif
+};
 
 /**********************
  *      MACROS
@@ -53,34 +88,6 @@ static void st7796s_send_color(void *data, uint16_t length);
 
 void st7796s_init(void)
 {
-	lcd_init_cmd_t init_cmds[] = {
-		{0xCF, {0x00, 0x83, 0X30}, 3},
-		{0xED, {0x64, 0x03, 0X12, 0X81}, 4},
-		{0xE8, {0x85, 0x01, 0x79}, 3},
-		{0xCB, {0x39, 0x2C, 0x00, 0x34, 0x02}, 5},
-		{0xF7, {0x20}, 1},
-		{0xEA, {0x00, 0x00}, 2},
-		{0xC0, {0x26}, 1},		 /*Power control*/
-		{0xC1, {0x11}, 1},		 /*Power control */
-		{0xC5, {0x35, 0x3E}, 2}, /*VCOM control*/
-		{0xC7, {0xBE}, 1},		 /*VCOM control*/
-		{0x36, {0x28}, 1},		 /*Memory Access Control*/
-		{0x3A, {0x55}, 1},		 /*Pixel Format Set*/
-		{0xB1, {0x00, 0x1B}, 2},
-		{0xF2, {0x08}, 1},
-		{0x26, {0x01}, 1},
-		{0xE0, {0x1F, 0x1A, 0x18, 0x0A, 0x0F, 0x06, 0x45, 0X87, 0x32, 0x0A, 0x07, 0x02, 0x07, 0x05, 0x00}, 15},
-		{0XE1, {0x00, 0x25, 0x27, 0x05, 0x10, 0x09, 0x3A, 0x78, 0x4D, 0x05, 0x18, 0x0D, 0x38, 0x3A, 0x1F}, 15},
-		{0x2A, {0x00, 0x00, 0x00, 0xEF}, 4},
-		{0x2B, {0x00, 0x00, 0x01, 0x3f}, 4},
-		{0x2C, {0}, 0},
-		{0xB7, {0x07}, 1},
-		{0xB6, {0x0A, 0x82, 0x27, 0x00}, 4},
-		{0x11, {0}, 0x80},
-		{0x29, {0}, 0x80},
-		{0, {0}, 0xff},
-	};
-
 #if ST7796S_BCKL == 15
 	gpio_config_t io_conf;
 	io_conf.intr_type = GPIO_PIN_INTR_DISABLE;
@@ -102,63 +109,16 @@ void st7796s_init(void)
 	gpio_set_direction(ST7796S_BCKL, GPIO_MODE_OUTPUT);
 #endif
 	//Reset the display
-	gpio_set_level(ST7796S_RST, 0);
-	vTaskDelay(100 / portTICK_RATE_MS);
-	gpio_set_level(ST7796S_RST, 1);
-	vTaskDelay(100 / portTICK_RATE_MS);
-
-	ESP_LOGI(TAG, "Initialization.");
-
-	//Send all the commands
-	uint16_t cmd = 0;
-	while (init_cmds[cmd].databytes != 0xff)
-	{
-		st7796s_send_cmd(init_cmds[cmd].cmd);
-		st7796s_send_data(init_cmds[cmd].data, init_cmds[cmd].databytes & 0x1F);
-		if (init_cmds[cmd].databytes & 0x80)
-		{
-			vTaskDelay(100 / portTICK_RATE_MS);
-		}
-		cmd++;
-	}
+	disp_mipi_reset(ST7796S_RST);
 
-	st7796s_enable_backlight(true);
+	disp_mipi_init(&st7796s_panel);
 
-	st7796s_set_orientation(CONFIG_LV_DISPLAY_ORIENTATION);
-
-#if ST7796S_INVERT_COLORS == 1
-	st7796s_send_cmd(0x21);
-#else
-	st7796s_send_cmd(0x20);
-#endif
+	st7796s_enable_backlight(true);
 }
 
 void st7796s_flush(lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t *color_map)
 {
-	uint8_t data[4];
-
-	/*Column addresses*/
-	st7796s_send_cmd(0x2A);
-	data[0] = (area->x1 >> 8) & 0xFF;
-	data[1] = area->x1 & 0xFF;
-	data[2] = (area->x2 >> 8) & 0xFF;
-	data[3] = area->x2 & 0xFF;
-	st7796s_send_data(data, 4);
-
-	/*Page addresses*/
-	st7796s_send_cmd(0x2B);
-	data[0] = (area->y1 >> 8) & 0xFF;
-	data[1] = area->y1 & 0xFF;
-	data[2] = (area->y2 >> 8) & 0xFF;
-	data[3] = area->y2 & 0xFF;
-	st7796s_send_data(data, 4);
-
-	/*Memory write*/
-	st7796s_send_cmd(0x2C);
-
-	uint32_t size = lv_area_get_width(area) * lv_area_get_height(area);
-
-	st7796s_send_color((void *)color_map, size * 2);
+	disp_mipi_flush(drv, area, color_map);
 }
 
 void st7796s_enable_backlight(bool backlight)
@@ -180,63 +140,17 @@ void st7796s_enable_backlight(bool backlight)
 void st7796s_sleep_in()
 {
 	uint8_t data[] = {0x08};
-	st7796s_send_cmd(0x10);
-	st7796s_send_data(&data, 1);
+	disp_mipi_send_cmd(DISP_MIPI_SLPIN);
+	disp_mipi_send_params(data, 1);
 }
 
 void st7796s_sleep_out()
 {
 	uint8_t data[] = {0x08};
-	st7796s_send_cmd(0x11);
-	st7796s_send_data(&data, 1);
+	disp_mipi_send_cmd(DISP_MIPI_SLPOUT);
+	disp_mipi_send_params(data, 1);
 }
 
 /**********************
  *   STATIC FUNCTIONS
  **********************/
-
-static void st7796s_send_cmd(uint8_t cmd)
-{
-	disp_wait_for_pending_transactions();
-	gpio_set_level(ST7796S_DC, 0); /*Command mode*/
-	disp_spi_send_data(&cmd, 1);
-}
-
-static void st7796s_send_data(void *data, uint16_t length)
-{
-	disp_wait_for_pending_transactions();
-	gpio_set_level(ST7796S_DC, 1); /*Data mode*/
-	disp_spi_send_data(data, length);
-}
-
-static void st7796s_send_color(void *data, uint16_t length)
-{
-	disp_wait_for_pending_transactions();
-	gpio_set_level(ST7796S_DC, 1); /*Data mode*/
-	disp_spi_send_colors(data, length);
-}
-
-static void st7796s_set_orientation(uint8_t orientation)
-{
-	// ESP_ASSERT(orientation < 4);
-
-	const char *orientation_str[] = {
-		"PORTRAIT", "PORTRAIT_INVERTED", "LANDSCAPE", "LANDSCAPE_INVERTED"};
-
-	ESP_LOGI(TAG, "Display orientation: %s", orientation_str[orientation]);
-
-#if defined CONFIG_LV_PREDEFINED_DISPLAY_M5STACK
-	uint8_t data[] = {0x68, 0x68, 0x08, 0x08};
-#elif defined(CONFIG_LV_PREDEFINED_DISPLAY_WROVER4)
-	uint8_t data[] = {0x4C, 0x88, 0x28, 0xE8};
-#elif defined(CONFIG_LV_PREDEFINED_DISPLAY_WT32_SC01)
-	uint8_t data[] = {0x48, 0x88, 0x28, 0xE8};
-#elif defined(CONFIG_LV_PREDEFINED_DISPLAY_NONE)
-	uint8_t data[] = {0x48, 0x88, 0x28, 0xE8};
-#endif
-
-	ESP_LOGI(TAG, "0x36 command value: 0x%02X", data[orientation]);
-
-	st7796s_send_cmd(0x36);
-	st7796s_send_data((void *)&data[orientation], 1);
-}
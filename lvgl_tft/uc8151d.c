@@ -32,6 +32,7 @@
 #include <esp_log.h>
 
 #include "disp_spi.h"
+#include "disp_pixconv.h"
 #include "disp_driver.h"
 #include "uc8151d.h"
 
@@ -48,9 +49,6 @@
 #define EPD_HEIGHT          LV_VER_RES_MAX
 #define EPD_ROW_LEN         (EPD_HEIGHT / 8u)
 
-#define BIT_SET(a, b)       ((a) |= (1U << (b)))
-#define BIT_CLEAR(a, b)     ((a) &= ~(1U << (b)))
-
 typedef struct
 {
     uint8_t cmd;
@@ -97,7 +95,7 @@ static void uc8151d_spi_send_fb(uint8_t *data, size_t len)
 {
     disp_wait_for_pending_transactions();
     gpio_set_level(PIN_DC, 1);   // DC = 1 for data
-    disp_spi_send_colors(data, len);
+    disp_spi_transaction(data, len, DISP_SPI_SEND_QUEUED, NULL, 0, 0);  // flush is signaled after the refresh
 }
 
 static void uc8151d_spi_send_seq(const uc8151d_seq_t *seq, size_t len)
@@ -211,15 +209,11 @@ void uc8151d_lv_fb_flush(lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t *
 void uc8151d_lv_set_fb_cb(struct _disp_drv_t *disp_drv, uint8_t *buf, lv_coord_t buf_w, lv_coord_t x, lv_coord_t y,
                            lv_color_t color, lv_opa_t opa)
 {
-    uint16_t byte_index = (x >> 3u) + (y * EPD_ROW_LEN);
-    uint8_t bit_index = x & 0x07u;
-
-    if (color.full) {
-        BIT_SET(buf[byte_index], 7 - bit_index);
-    } else {
+    if (!color.full) {
         ESP_LOGD(TAG, "Clear at x: %u, y: %u", x, y);
-        BIT_CLEAR(buf[byte_index], 7 - bit_index);
     }
+
+    disp_pixconv_mono_row_set(buf, EPD_ROW_LEN, x, y, color.full);
 }
 
 void uc8151d_lv_rounder_cb(struct _disp_drv_t *disp_drv, lv_area_t *area)
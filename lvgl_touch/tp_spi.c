@@ -16,6 +16,10 @@
 #include "../lvgl_helpers.h"
 #include "../lvgl_spi_conf.h"
 
+#if defined (SHARED_SPI_BUS)
+#include "../lvgl_tft/disp_spi.h"
+#endif
+
 /*********************
  *      DEFINES
  *********************/
@@ -28,11 +32,12 @@
 /**********************
  *  STATIC PROTOTYPES
  **********************/
-static spi_device_handle_t spi;
+static esp_err_t tp_spi_transmit(spi_transaction_t *t);
 
 /**********************
  *  STATIC VARIABLES
  **********************/
+static spi_device_handle_t spi;
 
 /**********************
  *      MACROS
@@ -73,7 +78,7 @@ void tp_spi_xchg(uint8_t* data_send, uint8_t* data_recv, uint8_t byte_count)
 		.tx_buffer = data_send,
 		.rx_buffer = data_recv};
 	
-	esp_err_t ret = spi_device_transmit(spi, &t);
+	esp_err_t ret = tp_spi_transmit(&t);
 	assert(ret == ESP_OK);
 }
 
@@ -85,7 +90,7 @@ void tp_spi_write_reg(uint8_t* data, uint8_t byte_count)
 	    .flags = 0
 	};
 	
-	esp_err_t ret = spi_device_transmit(spi, &t);
+	esp_err_t ret = tp_spi_transmit(&t);
 	assert(ret == ESP_OK);
 }
 
@@ -100,10 +105,22 @@ void tp_spi_read_reg(uint8_t reg, uint8_t* data, uint8_t byte_count)
 	};
 	
 	// Read - send first byte as command
-	esp_err_t ret = spi_device_transmit(spi, &t);
+	esp_err_t ret = tp_spi_transmit(&t);
 	assert(ret == ESP_OK);
 }
 
 /**********************
  *   STATIC FUNCTIONS
  **********************/
+static esp_err_t tp_spi_transmit(spi_transaction_t *t)
+{
+#if defined (SHARED_SPI_BUS)
+	/* don't wait behind a whole frame of queued pixel data */
+	disp_spi_priority_request();
+	esp_err_t ret = spi_device_transmit(spi, t);
+	disp_spi_priority_release();
+	return ret;
+#else
+	return spi_device_transmit(spi, t);
+#endif
+}
@@ -0,0 +1,100 @@
+/**
+ * @file pixconv_bench.c
+ *
+ * Microbenchmark of the disp_pixconv conversions next to the plain per
+ * pixel reference ones, over a 320x240 frame. The references are called out
+ * of line like the kernels, so neither side gets to know its buffers don't
+ * overlap. The numbers are host ones, they don't predict the timing on the
+ * target.
+ */
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "disp_pixconv.h"
+#include "pixconv_ref.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+#define FRAME_W     320
+#define FRAME_H     240
+#define FRAME_PX    (FRAME_W * FRAME_H)
+#define MIN_NS      200000000LL     /* run each kernel for at least 0.2s */
+
+/* Call through a volatile pointer so the reference isn't inlined */
+#define REF(fn)     (*(__typeof__(&fn) volatile) { &fn })
+
+/* Repeat call for at least MIN_NS and print the time per pixel */
+#define BENCH(name, call)                                                       \
+    do {                                                                        \
+        long long runs = 0, start = now_ns(), elapsed;                          \
+        do {                                                                    \
+            call;                                                               \
+            sink ^= out[runs % sizeof(out)];                                    \
+            runs++;                                                             \
+        } while ((elapsed = now_ns() - start) < MIN_NS);                        \
+        printf("%-24s %8.2f ns/px %10.1f Mpx/s\n", name,                        \
+            (double) elapsed / runs / FRAME_PX,                                 \
+            (double) runs * FRAME_PX * 1000.0 / elapsed);                       \
+    } while (0)
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+static uint16_t src16[FRAME_PX];
+static uint8_t src8[FRAME_PX];
+static uint32_t out_words[FRAME_PX];
+static uint8_t *const out = (uint8_t *) out_words;
+static volatile uint8_t sink;
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+static long long now_ns(void);
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+int main(void)
+{
+    srand(1);
+    for (size_t i = 0; i < FRAME_PX; i++) {
+        src16[i] = (uint16_t) rand();
+        src8[i] = (rand() & 1) ? 0xFF : 0x00;
+    }
+
+    BENCH("swap16",             disp_pixconv_swap16((uint16_t *) out, src16, FRAME_PX));
+    BENCH("swap16 ref",         REF(ref_swap16)((uint16_t *) out, src16, FRAME_PX));
+    BENCH("rgb565_to_rgb666",   disp_pixconv_rgb565_to_rgb666(out, src16, FRAME_PX));
+    BENCH("rgb565_to_rgb666 ref", REF(ref_rgb565_to_rgb666)(out, src16, FRAME_PX));
+    BENCH("rgb565_to_rgb888",   disp_pixconv_rgb565_to_rgb888(out, src16, FRAME_PX));
+    BENCH("rgb565_to_rgb888 ref", REF(ref_rgb565_to_rgb888)(out, src16, FRAME_PX));
+    BENCH("rgb565_to_rgb444",   disp_pixconv_rgb565_to_rgb444(out, src16, FRAME_PX));
+    BENCH("rgb565_to_rgb444 ref", REF(ref_rgb565_to_rgb444)(out, src16, FRAME_PX));
+    BENCH("mono_page",          disp_pixconv_mono_page(out, src8, FRAME_W, FRAME_H));
+    BENCH("mono_page ref",      REF(ref_mono_page)(out, src8, FRAME_W, FRAME_H, 0));
+    BENCH("mono_page_inv",      disp_pixconv_mono_page_inv(out, src8, FRAME_W, FRAME_H));
+    BENCH("mono_page_inv ref",  REF(ref_mono_page)(out, src8, FRAME_W, FRAME_H, 1));
+    BENCH("mono_cols_inv",      disp_pixconv_mono_cols_inv(out, src8, FRAME_W, FRAME_H));
+    BENCH("mono_cols_inv ref",  REF(ref_mono_cols_inv)(out, src8, FRAME_W, FRAME_H));
+    BENCH("mono_row",           disp_pixconv_mono_row(out, src8, FRAME_W, FRAME_H));
+    BENCH("mono_row ref",       REF(ref_mono_row)(out, src8, FRAME_W, FRAME_H));
+
+    return 0;
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+static long long now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
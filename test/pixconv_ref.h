@@ -0,0 +1,128 @@
+/**
+ * @file pixconv_ref.h
+ *
+ * Plain per pixel versions of the disp_pixconv conversions, the reference
+ * for the tests and the baseline of the benchmark.
+ */
+
+#ifndef PIXCONV_REF_H
+#define PIXCONV_REF_H
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include <stddef.h>
+#include <stdint.h>
+
+/*********************
+ *      DEFINES
+ *********************/
+#define REF_R5(p)   (((p) >> 11) & 0x1F)
+#define REF_G6(p)   (((p) >> 5) & 0x3F)
+#define REF_B5(p)   ((p) & 0x1F)
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+static inline void ref_swap16(uint16_t *dst, const uint16_t *src, size_t pixels)
+{
+    for (size_t i = 0; i < pixels; i++) {
+        dst[i] = (uint16_t) ((src[i] << 8) | (src[i] >> 8));
+    }
+}
+
+/* 5 bit channels are widened to 6 bits by copying their top bit below */
+static inline void ref_rgb565_to_rgb666(uint8_t *dst, const uint16_t *src, size_t pixels)
+{
+    for (size_t i = 0; i < pixels; i++) {
+        uint16_t p = src[i];
+        *dst++ = ((REF_R5(p) << 1) | (REF_R5(p) >> 4)) << 2;
+        *dst++ = REF_G6(p) << 2;
+        *dst++ = ((REF_B5(p) << 1) | (REF_B5(p) >> 4)) << 2;
+    }
+}
+
+static inline void ref_rgb565_to_rgb888(uint8_t *dst, const uint16_t *src, size_t pixels)
+{
+    for (size_t i = 0; i < pixels; i++) {
+        uint16_t p = src[i];
+        *dst++ = (REF_R5(p) << 3) | (REF_R5(p) >> 2);
+        *dst++ = (REF_G6(p) << 2) | (REF_G6(p) >> 4);
+        *dst++ = (REF_B5(p) << 3) | (REF_B5(p) >> 2);
+    }
+}
+
+/* Two pixels in 3 bytes, an odd last pixel takes 2 bytes */
+static inline void ref_rgb565_to_rgb444(uint8_t *dst, const uint16_t *src, size_t pixels)
+{
+    for (size_t i = 0; i < pixels; i++) {
+        uint16_t p = src[i];
+        uint16_t v = ((REF_R5(p) >> 1) << 8) | ((REF_G6(p) >> 2) << 4) | (REF_B5(p) >> 1);
+        uint8_t *d = &dst[i / 2 * 3];
+
+        if (i & 1) {
+            d[1] = (d[1] & 0xF0) | (v >> 8);
+            d[2] = v & 0xFF;
+        } else {
+            d[0] = v >> 4;
+            d[1] = (v & 0x0F) << 4;
+        }
+    }
+}
+
+static inline void ref_u8_to_be16(uint8_t *dst, const uint8_t *src, size_t length)
+{
+    for (size_t i = 0; i < length; i++) {
+        dst[2 * i] = 0x00;
+        dst[2 * i + 1] = src[i];
+    }
+}
+
+/* on selects the pixels to set, non zero ones or zero ones for the inv
+   variants */
+static inline void ref_mono_page(uint8_t *dst, const uint8_t *src, uint16_t w, uint16_t h, int inv)
+{
+    for (size_t i = 0; i < (size_t) w * ((h + 7) / 8); i++) {
+        dst[i] = 0;
+    }
+    for (uint16_t y = 0; y < h; y++) {
+        for (uint16_t x = 0; x < w; x++) {
+            if ((src[x + y * w] != 0) != inv) {
+                dst[x + (y / 8) * w] |= 1 << (y % 8);
+            }
+        }
+    }
+}
+
+static inline void ref_mono_row(uint8_t *dst, const uint8_t *src, uint16_t w, uint16_t h)
+{
+    uint16_t row_len = (w + 7) / 8;
+
+    for (size_t i = 0; i < (size_t) row_len * h; i++) {
+        dst[i] = 0;
+    }
+    for (uint16_t y = 0; y < h; y++) {
+        for (uint16_t x = 0; x < w; x++) {
+            if (src[x + y * w]) {
+                dst[x / 8 + y * row_len] |= 0x80 >> (x % 8);
+            }
+        }
+    }
+}
+
+static inline void ref_mono_cols_inv(uint8_t *dst, const uint8_t *src, uint16_t w, uint16_t h)
+{
+    for (size_t i = 0; i < (size_t) h * ((w + 7) / 8); i++) {
+        dst[i] = 0;
+    }
+    for (uint16_t y = 0; y < h; y++) {
+        for (uint16_t x = 0; x < w; x++) {
+            if (src[x + y * w] == 0) {
+                dst[y + (x / 8) * h] |= 1 << (x % 8);
+            }
+        }
+    }
+}
+
+#endif /*PIXCONV_REF_H*/
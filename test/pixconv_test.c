@@ -0,0 +1,223 @@
+/**
+ * @file pixconv_test.c
+ *
+ * Checks the disp_pixconv conversions against the reference ones, over
+ * random pixels, odd lengths and unaligned buffers.
+ */
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "disp_pixconv.h"
+#include "pixconv_ref.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+#define MAX_PIXELS  1024
+#define MAX_W       67
+#define MAX_H       35
+
+#define CHECK(cond, ...)                                \
+    do {                                                \
+        if (!(cond)) {                                  \
+            printf("FAIL %s:%d: ", __FILE__, __LINE__); \
+            printf(__VA_ARGS__);                        \
+            printf("\n");                               \
+            failures++;                                 \
+        }                                               \
+    } while (0)
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+static unsigned failures;
+
+static uint16_t src16[MAX_PIXELS + 2];
+/* the 3 bytes per pixel kernels store words, their dst must be aligned */
+static uint32_t out_buf[MAX_PIXELS];
+static uint32_t ref_buf[MAX_PIXELS];
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+static void fill_random(void *buf, size_t size, unsigned zero_pct);
+static void test_swap16(void);
+static void test_rgb(void);
+static void test_u8_to_be16(void);
+static void test_mono(void);
+static void test_mono_set(void);
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+int main(void)
+{
+    srand(1);
+
+    test_swap16();
+    test_rgb();
+    test_u8_to_be16();
+    test_mono();
+    test_mono_set();
+
+    if (failures) {
+        printf("%u failures\n", failures);
+        return 1;
+    }
+
+    printf("OK\n");
+    return 0;
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+/* Random bytes, about zero_pct percent of them zero */
+static void fill_random(void *buf, size_t size, unsigned zero_pct)
+{
+    uint8_t *b = (uint8_t *) buf;
+
+    for (size_t i = 0; i < size; i++) {
+        b[i] = ((unsigned) rand() % 100 < zero_pct) ? 0 : (uint8_t) (rand() | 1);
+    }
+}
+
+static void test_swap16(void)
+{
+    static uint16_t in_place[MAX_PIXELS + 2];
+
+    for (size_t n = 0; n <= 64; n++) {
+        /* every mix of word and half word aligned source and destination */
+        for (size_t so = 0; so < 2; so++) {
+            for (size_t d_o = 0; d_o < 2; d_o++) {
+                uint16_t *out = (uint16_t *) out_buf + d_o;
+                uint16_t *ref = (uint16_t *) ref_buf + d_o;
+
+                fill_random(src16, sizeof(src16), 0);
+                disp_pixconv_swap16(out, src16 + so, n);
+                ref_swap16(ref, src16 + so, n);
+                CHECK(memcmp(out, ref, n * 2) == 0, "swap16 n=%zu src+%zu dst+%zu", n, so, d_o);
+            }
+        }
+
+        /* in place, as nv6001 does */
+        fill_random(in_place, sizeof(in_place), 0);
+        ref_swap16((uint16_t *) ref_buf, in_place + 1, n);
+        disp_pixconv_swap16(in_place + 1, in_place + 1, n);
+        CHECK(memcmp(in_place + 1, ref_buf, n * 2) == 0, "swap16 in place n=%zu", n);
+    }
+}
+
+static void test_rgb(void)
+{
+    static const struct {
+        const char *name;
+        void (*conv)(uint8_t *, const uint16_t *, size_t);
+        void (*ref)(uint8_t *, const uint16_t *, size_t);
+    } kernels[] = {
+        {"rgb666", disp_pixconv_rgb565_to_rgb666, ref_rgb565_to_rgb666},
+        {"rgb888", disp_pixconv_rgb565_to_rgb888, ref_rgb565_to_rgb888},
+        {"rgb444", disp_pixconv_rgb565_to_rgb444, ref_rgb565_to_rgb444},
+    };
+
+    for (size_t k = 0; k < sizeof(kernels) / sizeof(kernels[0]); k++) {
+        for (size_t n = 0; n <= 67; n++) {
+            size_t bytes = (k == 2) ? (n * 3 + 1) / 2 : n * 3;
+
+            for (size_t so = 0; so < 2; so++) {
+                fill_random(src16, sizeof(src16), 0);
+                memset(out_buf, 0xA5, sizeof(out_buf));
+                memset(ref_buf, 0xA5, sizeof(ref_buf));
+
+                kernels[k].conv((uint8_t *) out_buf, src16 + so, n);
+                kernels[k].ref((uint8_t *) ref_buf, src16 + so, n);
+                CHECK(memcmp(out_buf, ref_buf, bytes) == 0, "%s n=%zu src+%zu", kernels[k].name, n, so);
+                CHECK(((uint8_t *) out_buf)[bytes] == 0xA5, "%s n=%zu writes past the end", kernels[k].name, n);
+            }
+        }
+    }
+
+    /* the channel extremes map to the extremes of the wider formats */
+    uint16_t white = 0xFFFF, black = 0x0000;
+    uint8_t out[4];
+
+    disp_pixconv_rgb565_to_rgb888(out, &white, 1);
+    CHECK(out[0] == 0xFF && out[1] == 0xFF && out[2] == 0xFF, "rgb888 white");
+    disp_pixconv_rgb565_to_rgb666(out, &white, 1);
+    CHECK(out[0] == 0xFC && out[1] == 0xFC && out[2] == 0xFC, "rgb666 white");
+    disp_pixconv_rgb565_to_rgb888(out, &black, 1);
+    CHECK(out[0] == 0 && out[1] == 0 && out[2] == 0, "rgb888 black");
+}
+
+static void test_u8_to_be16(void)
+{
+    uint8_t src[64];
+
+    for (size_t n = 0; n <= sizeof(src); n++) {
+        fill_random(src, sizeof(src), 10);
+        disp_pixconv_u8_to_be16((uint8_t *) out_buf, src, n);
+        ref_u8_to_be16((uint8_t *) ref_buf, src, n);
+        CHECK(memcmp(out_buf, ref_buf, n * 2) == 0, "u8_to_be16 n=%zu", n);
+    }
+}
+
+static void test_mono(void)
+{
+    static uint8_t src[MAX_W * MAX_H + 1];
+    static uint8_t out[MAX_W * MAX_H];
+    static uint8_t ref[MAX_W * MAX_H];
+
+    for (uint16_t h = 1; h <= MAX_H; h++) {
+        for (uint16_t w = 1; w <= MAX_W; w++) {
+            /* the LVGL rows of a flush area aren't word aligned */
+            uint8_t *s = src + (w & 1);
+            size_t page_bytes = (size_t) w * ((h + 7) / 8);
+            size_t row_bytes = (size_t) h * ((w + 7) / 8);
+
+            fill_random(s, (size_t) w * h, 50);
+
+            disp_pixconv_mono_page(out, s, w, h);
+            ref_mono_page(ref, s, w, h, 0);
+            CHECK(memcmp(out, ref, page_bytes) == 0, "mono_page %ux%u", w, h);
+
+            disp_pixconv_mono_row(out, s, w, h);
+            ref_mono_row(ref, s, w, h);
+            CHECK(memcmp(out, ref, row_bytes) == 0, "mono_row %ux%u", w, h);
+
+            disp_pixconv_mono_page_inv(out, s, w, h);
+            ref_mono_page(ref, s, w, h, 1);
+            CHECK(memcmp(out, ref, page_bytes) == 0, "mono_page_inv %ux%u", w, h);
+
+            disp_pixconv_mono_cols_inv(out, s, w, h);
+            ref_mono_cols_inv(ref, s, w, h);
+            CHECK(memcmp(out, ref, row_bytes) == 0, "mono_cols_inv %ux%u", w, h);
+        }
+    }
+}
+
+static void test_mono_set(void)
+{
+    uint8_t buf[16 * 2];
+
+    memset(buf, 0, sizeof(buf));
+    disp_pixconv_mono_page_set(buf, 16, 3, 10, true);
+    CHECK(buf[16 + 3] == 0x04, "mono_page_set");
+    disp_pixconv_mono_page_set(buf, 16, 3, 10, false);
+    CHECK(buf[16 + 3] == 0x00, "mono_page_set clear");
+
+    disp_pixconv_mono_page_set_msb(buf, 16, 3, 10, true);
+    CHECK(buf[16 + 3] == 0x20, "mono_page_set_msb");
+    disp_pixconv_mono_page_set_msb(buf, 16, 3, 10, false);
+    CHECK(buf[16 + 3] == 0x00, "mono_page_set_msb clear");
+
+    disp_pixconv_mono_row_set(buf, 2, 10, 1, true);
+    CHECK(buf[2 + 1] == 0x20, "mono_row_set");
+    disp_pixconv_mono_row_set(buf, 2, 10, 1, false);
+    CHECK(buf[2 + 1] == 0x00, "mono_row_set clear");
+}
@@ -0,0 +1,6 @@
+/**
+ * @file sdkconfig.h
+ *
+ * Empty stand-in for the ESP-IDF generated configuration, the conversions
+ * under test don't depend on it.
+ */